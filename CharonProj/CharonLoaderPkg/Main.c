@@ -345,7 +345,8 @@ EFI_STATUS EFIAPI UefiMain(
     gop->Mode->Info->PixelsPerScanLine,
     gop->Mode->Info->HorizontalResolution,
     gop->Mode->Info->VerticalResolution,
-    0
+    0,
+    {0, 0, 0, 0}
   };
   switch (gop->Mode->Info->PixelFormat) {
     case PixelRedGreenBlueReserved8BitPerColor:
@@ -354,6 +355,13 @@ EFI_STATUS EFIAPI UefiMain(
     case PixelBlueGreenRedReserved8BitPerColor:
       config.pixel_format = kPixelBGRResv8BitPerColor;
       break;
+    case PixelBitMask:
+      config.pixel_format = kPixelBitMask;
+      config.pixel_bitmask.red_mask = gop->Mode->Info->PixelInformation.RedMask;
+      config.pixel_bitmask.green_mask = gop->Mode->Info->PixelInformation.GreenMask;
+      config.pixel_bitmask.blue_mask = gop->Mode->Info->PixelInformation.BlueMask;
+      config.pixel_bitmask.reserved_mask = gop->Mode->Info->PixelInformation.ReservedMask;
+      break;
     default:
       Print(L"Unimplemented pixel format: %d\n", gop->Mode->Info->PixelFormat);
       Halt();
@@ -5,6 +5,14 @@
 enum PixelFormat {
   kPixelRGBResv8BitPerColor,
   kPixelBGRResv8BitPerColor,
+  kPixelBitMask,
+};
+
+struct PixelBitmask {
+  uint32_t red_mask;
+  uint32_t green_mask;
+  uint32_t blue_mask;
+  uint32_t reserved_mask;
 };
 
 struct FrameBufferConfig {
@@ -13,4 +21,5 @@ struct FrameBufferConfig {
   uint32_t horizontal_resolution;
   uint32_t vertical_resolution;
   enum PixelFormat pixel_format;
+  struct PixelBitmask pixel_bitmask;
 };
@@ -27,12 +27,17 @@ clean_func() {
     mv *.o                                      ../trash 2>/dev/null
     mv lib/graphics/*.o                         ../trash 2>/dev/null
     mv lib/font/font.o                          ../trash 2>/dev/null
+    mv lib/font/unicode_font.o                  ../trash 2>/dev/null
+    mv lib/font/unicodeFont.o                   ../trash 2>/dev/null
+    mv lib/font/unicodeFont.bin                 ../trash 2>/dev/null
     mv lib/terminal/terminal.o                  ../trash 2>/dev/null 
     mv kernel.elf                               ../trash 2>/dev/null
     mv lib/pci/pci.o                            ../trash 2>/dev/null
     mv lib/io/io_func.o                         ../trash 2>/dev/null
     mv lib/mouse/mouse.o                        ../trash 2>/dev/null
     mv lib/log/logger.o                         ../trash 2>/dev/null
+    mv lib/log/format.o                         ../trash 2>/dev/null
+    mv lib/serial/serial.o                      ../trash 2>/dev/null
     mv lib/interrupt/interrupt_asm.o            ../trash 2>/dev/null
     mv lib/interrupt/interrupt.o                ../trash 2>/dev/null
     mv lib/memory/new_entry.o                   ../trash 2>/dev/null
@@ -42,6 +47,9 @@ clean_func() {
     mv lib/memory/paging/paging_asm.o           ../trash 2>/dev/null
     mv lib/memory/MMR/memory_manager.o          ../trash 2>/dev/null
     mv lib/compositor/window/window.o           ../trash 2>/dev/null
+    mv lib/cpu/cpu.o                            ../trash 2>/dev/null
+    mv lib/cpu/cpu_asm.o                        ../trash 2>/dev/null
+    mv lib/compositor/layer/layer.o             ../trash 2>/dev/null
     
 
 
@@ -68,8 +76,12 @@ dclean_func() {
     mv .newlib_support.d                    ../trash 2>/dev/null
     mv .libcxx_support.d                    ../trash 2>/dev/null
     mv lib/font/.font.d                     ../trash 2>/dev/null
+    mv lib/font/.unicode_font.d             ../trash 2>/dev/null
+    mv lib/font/.unicodeFont.d              ../trash 2>/dev/null
     mv lib/graphics/.graphics.d             ../trash 2>/dev/null
     mv lib/log/.logger.d                    ../trash 2>/dev/null
+    mv lib/log/.format.d                    ../trash 2>/dev/null
+    mv lib/serial/.serial.d                 ../trash 2>/dev/null
     mv lib/mouse/.mouse.d                   ../trash 2>/dev/null
     mv lib/terminal/.terminal.d             ../trash 2>/dev/null
     mv lib/pci/.pci.d                       ../trash 2>/dev/null
@@ -78,6 +90,11 @@ dclean_func() {
     mv lib/memory/paging/.paging.d          ../trash 2>/dev/null
     mv lib/memory/MMR/.memory_manager.d     ../trash 2>/dev/null
     mv lib/compositor/window/.window.d      ../trash 2>/dev/null
+    mv lib/cpu/.cpu.d                       ../trash 2>/dev/null
+    mv lib/graphics/.pixel_ops.d            ../trash 2>/dev/null
+    mv lib/graphics/.back_buffer.d          ../trash 2>/dev/null
+    mv lib/graphics/.cursor_plane.d         ../trash 2>/dev/null
+    mv lib/compositor/layer/.layer.d        ../trash 2>/dev/null
 
     
 
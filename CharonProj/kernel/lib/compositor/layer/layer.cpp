@@ -1,6 +1,7 @@
 #include "layer.hpp"
 
 #include <algorithm>
+#include <array>
 
 
 
@@ -29,9 +30,39 @@ Layer& Layer::MoveRelative(Vector2D<int> pos_diff) {
     return *this;
 }
 
-void Layer::DrawTo(PixelWriter& writer) const {
+Layer& Layer::SetOpacity(uint8_t opacity) {
+    opacity_ = opacity;
+    return *this;
+}
+
+uint8_t Layer::Opacity() const {
+    return opacity_;
+}
+
+Vector2D<int> Layer::GetPosition() const {
+    return pos_;
+}
+
+Rectangle<int> Layer::Area() const {
+    if (!window_) {
+        return {pos_, {0, 0}};
+    }
+    return {pos_, {window_->Width(), window_->Height()}};
+}
+
+bool Layer::IsOpaque() const {
+    return window_ && window_->IsOpaque() && opacity_ == 255;
+}
+
+void Layer::DrawTo(NativePixelWriter& writer) const {
+    if (window_) {
+        window_ -> DrawTo(writer, pos_, Area(), opacity_);
+    }
+}
+
+void Layer::DrawTo(NativePixelWriter& writer, const Rectangle<int>& area) const {
     if (window_) {
-        window_ -> DrawTo(writer, pos_);
+        window_ -> DrawTo(writer, pos_, area, opacity_);
     }
 }
 
@@ -41,7 +72,7 @@ void Layer::DrawTo(PixelWriter& writer) const {
  * LayerManager 구현
 */
 
-void LayerManager::SetWriter(PixelWriter* writer) {
+void LayerManager::SetWriter(NativePixelWriter* writer) {
     writer_ = writer;
 }
 
@@ -51,64 +82,301 @@ Layer& LayerManager::NewLayer() {
 }
 
 void LayerManager::Draw() const {
-    for (auto layer : layer_stack_) {
-        layer->DrawTo(*writer_);
+    Draw(Rectangle<int>{{0, 0}, {writer_->Width(), writer_->Height()}});
+}
+
+void LayerManager::Draw(const Rectangle<int>& area) const {
+    DrawArea(area);
+    writer_->Flush();
+}
+
+void LayerManager::Draw(unsigned int id) const {
+    if (auto layer = FindLayer(id)) {
+        Draw(layer->Area());
+    }
+}
+
+/*
+ * 아래 레이어부터 차례로 덮어 그린 뒤 Flush()를 호출한다. 
+ * writer_가 BackBuffer라면 중간 상태는 화면에 보이지 않고, 완성된 결과만 한 번에 반영된다.
+ *
+ */
+
+
+namespace {
+    template <typename OutputIt>
+    OutputIt SubtractRectangle(const Rectangle<int>& a, const Rectangle<int>& b, OutputIt out) {
+        const auto overlap = a & b;
+        if (overlap.IsEmpty()) {
+            *out++ = a;
+            return out;
+        }
+
+        const int a_right = a.pos.x + a.size.x;
+        const int a_bottom = a.pos.y + a.size.y;
+        const int o_right = overlap.pos.x + overlap.size.x;
+        const int o_bottom = overlap.pos.y + overlap.size.y;
+
+        if (overlap.pos.y > a.pos.y) {                                      // 위
+            *out++ = Rectangle<int>{a.pos, {a.size.x, overlap.pos.y - a.pos.y}};
+        }
+        if (o_bottom < a_bottom) {                                          // 아래
+            *out++ = Rectangle<int>{{a.pos.x, o_bottom}, {a.size.x, a_bottom - o_bottom}};
+        }
+        if (overlap.pos.x > a.pos.x) {                                      // 왼쪽
+            *out++ = Rectangle<int>{{a.pos.x, overlap.pos.y}, {overlap.pos.x - a.pos.x, overlap.size.y}};
+        }
+        if (o_right < a_right) {                                            // 오른쪽
+            *out++ = Rectangle<int>{{o_right, overlap.pos.y}, {a_right - o_right, overlap.size.y}};
+        }
+        return out;
     }
+
+    /*
+     * 직사각형 a에서 b와 겹치는 부분을 뺀 나머지를 최대 4개의 겹치지 않는 직사각형으로 나누어 출력한다.
+     * 위, 아래 조각은 a의 폭 전체를 차지하고, 왼쪽, 오른쪽 조각은 겹친 부분의 높이만큼만 차지한다.
+     *
+     */
+
+    struct LayerClip {
+        const Layer* layer;
+        size_t first;                                   // clip_rects에서 이 레이어의 첫 직사각형 위치
+        size_t count;                                   // 이 레이어가 그려야 하는 직사각형의 개수
+    };
+
+    const size_t kMaxUncovered = 32;                    // 아직 가려지지 않은 영역을 나타내는 직사각형의 최대 개수
+    const size_t kMaxClipRects = 128;                   // 모든 레이어의 보이는 영역을 합한 직사각형의 최대 개수
+    const size_t kMaxClips = 32;                        // 보이는 영역이 있는 레이어의 최대 개수
 }
 
+
+void LayerManager::DrawArea(const Rectangle<int>& area) const {
+    if (area.IsEmpty()) {
+        return;
+    }
+
+    std::array<Rectangle<int>, kMaxUncovered> uncovered, next;        // 1)
+    std::array<Rectangle<int>, kMaxClipRects> clip_rects;
+    std::array<LayerClip, kMaxClips> clips;
+    uncovered[0] = area;
+    size_t num_uncovered = 1, num_clip_rects = 0, num_clips = 0;
+
+    for (const Layer* layer = top_; layer != nullptr && num_uncovered > 0; layer = layer->below_) {
+        if (num_clips == kMaxClips || num_clip_rects + num_uncovered > kMaxClipRects) {   // 2)
+            DrawBottomUp(area);
+            return;
+        }
+        const auto layer_area = layer->Area();
+
+        const size_t first = num_clip_rects;                            // 3)
+        for (size_t i = 0; i < num_uncovered; ++i) {
+            const auto visible = uncovered[i] & layer_area;
+            if (!visible.IsEmpty()) {
+                clip_rects[num_clip_rects++] = visible;
+            }
+        }
+        if (num_clip_rects == first) {
+            continue;
+        }
+        clips[num_clips++] = {layer, first, num_clip_rects - first};
+
+        if (layer->IsOpaque() && 4 * num_uncovered <= kMaxUncovered) { // 4)
+            auto out = next.begin();
+            for (size_t i = 0; i < num_uncovered; ++i) {
+                out = SubtractRectangle(uncovered[i], layer_area, out);
+            }
+            num_uncovered = out - next.begin();
+            uncovered.swap(next);
+        }
+    }
+
+    for (size_t c = num_clips; c-- > 0; ) {                             // 5)
+        for (size_t i = 0; i < clips[c].count; ++i) {
+            clips[c].layer->DrawTo(*writer_, clip_rects[clips[c].first + i]);
+        }
+    }
+}
+
+/*
+ * area 안쪽만 다시 그린다. 불투명한 레이어에 가려진 부분은 그리지 않는다.
+ * 화면을 다시 그릴 때마다 호출되므로, 힙을 쓰지 않고 크기가 정해진 스택의 배열만 사용한다.
+ *
+ * 동작방식:
+ *  1) uncovered는 area 중 아직 불투명한 레이어에 가려지지 않은 영역을 겹치지 않는 
+ *     직사각형 목록으로 나타낸다. 처음에는 area 전체이다.
+ *
+ *  2) 배열이 가득 차서 보이는 영역을 더 기록할 수 없다면, DrawBottomUp()으로 area에 걸친
+ *     모든 레이어를 아래부터 그린다. 가려진 부분도 그리므로 느리지만 결과는 같다.
+ *
+ *  3) 위의 레이어부터 내려가며, uncovered 중 레이어와 겹치는 부분을 그 레이어가 
+ *     그려야 하는 영역(보이는 영역)으로 기록한다.
+ *
+ *  4) 불투명한 레이어라면 그 아래에서는 레이어 영역이 보이지 않으므로 uncovered에서 뺀다. 
+ *     uncovered가 비면 더 아래의 레이어는 전혀 보이지 않으므로 멈춘다.
+ *     직사각형 하나는 최대 4개로 나뉘므로, 결과가 배열에 들어가지 않을 수 있다면 빼지 않는다.
+ *     그 아래의 레이어가 조금 더 그려지지만, 이 레이어가 나중에 그 위를 덮으므로 결과는 같다.
+ *
+ *  5) 투명색이 있는 레이어는 아래 레이어 위에 겹쳐 그려야 하므로, 기록한 순서의 반대
+ *     (아래에서 위)로 각 레이어의 보이는 영역만 그린다.
+ *
+ * 투명색이 없는 레이어만 있다면 area의 모든 픽셀은 정확히 한 번씩 그려진다. 
+ * 따라서 불투명한 창을 여러 장 겹쳐도 비용은 화면을 한 번 그리는 것과 같다.
+ *
+ */
+
+
+void LayerManager::DrawBottomUp(const Rectangle<int>& area) const {
+    for (const Layer* layer = bottom_; layer != nullptr; layer = layer->above_) {
+        const auto visible = area & layer->Area();
+        if (!visible.IsEmpty()) {
+            layer->DrawTo(*writer_, visible);
+        }
+    }
+}
+
+
+void LayerManager::MoveAndRedraw(Layer* layer, Vector2D<int> new_position) {
+    const auto old_area = layer->Area();
+    layer->Move(new_position);
+    const auto new_area = layer->Area();
+
+    if ((old_area & new_area).IsEmpty()) {                          // 1)
+        DrawArea(old_area);
+        DrawArea(new_area);
+    } else {
+        DrawArea(old_area | new_area);                              // 2)
+    }
+    writer_->Flush();
+}
+
+/*
+ * 동작방식:
+ *  1) 옮기기 전과 후의 영역이 겹치지 않는다면 두 영역을 따로 다시 그린다. 
+ *     두 영역을 합친 직사각형은 멀리 떨어진 경우 매우 커질 수 있기 때문이다.
+ *
+ *  2) 겹친다면 두 영역을 합친 직사각형 하나를 다시 그린다. 겹친 부분을 두 번 그리지 않는다.
+ *
+ */
+
+
 void LayerManager::Move(unsigned int id, Vector2D<int> new_position) {
-    FindLayer(id) -> Move(new_position);
+    if (auto layer = FindLayer(id)) {
+        MoveAndRedraw(layer, new_position);
+    }
 }
 
 void LayerManager::MoveRelative(unsigned int id, Vector2D<int> pos_diff) {
-    FindLayer(id) -> MoveRelative(pos_diff);
+    if (auto layer = FindLayer(id)) {
+        auto new_position = layer->GetPosition();
+        new_position += pos_diff;
+        MoveAndRedraw(layer, new_position);
+    }
+}
+
+
+void LayerManager::Unlink(Layer* layer) {
+    if (!layer->visible_) {
+        return;
+    }
+
+    (layer->below_ ? layer->below_->above_ : bottom_) = layer->above_;
+    (layer->above_ ? layer->above_->below_ : top_) = layer->below_;
+    layer->below_ = layer->above_ = nullptr;
+    layer->visible_ = false;
+    --num_visible_;
 }
 
+void LayerManager::LinkAbove(Layer* layer, Layer* below) {
+    Layer* above = below ? below->above_ : bottom_;
+
+    layer->below_ = below;
+    layer->above_ = above;
+    (below ? below->above_ : bottom_) = layer;
+    (above ? above->below_ : top_) = layer;
+    layer->visible_ = true;
+    ++num_visible_;
+}
+
+/*
+ * 보이는 레이어들은 아래에서 위로 이어지는 이중 연결 리스트(bottom_ ~ top_)로 관리된다.
+ *
+ * Unlink():
+ *  레이어를 리스트에서 빼낸다. 
+ *
+ * LinkAbove():
+ *  레이어를 below 바로 위에 넣는다. below가 nullptr이면 가장 아래에 넣는다.
+ *
+ * 두 함수 모두 이웃한 레이어의 포인터만 바꾸므로 O(1)이다. 
+ * 기존의 std::vector는 레이어를 빼거나 넣을 때마다 뒤의 원소를 모두 옮겨야 했다.
+ *
+ */
+
 
 void LayerManager::UpDown(unsigned int id, int new_height) {
     if (new_height < 0) {
         Hide(id);
         return;
     }
-    if (new_height > layer_stack_.size()) {
-        new_height = layer_stack_.size();
-    }
 
     auto layer = FindLayer(id);
-    auto old_pos = std::find(layer_stack_.begin(), layer_stack_.end(), layer);
-    auto new_pos = layer_stack_.begin() + new_height;
-
-    if (old_pos == layer_stack_.end()) {
-        layer_stack_.insert(new_pos, layer);
+    if (layer == nullptr) {
         return;
     }
-    if (new_pos == layer_stack_.end()) {
-        --new_pos;
-    }
+    Unlink(layer);
 
-    layer_stack_.erase(old_pos);
-    layer_stack_.insert(new_pos, layer);
+    const size_t height = std::min(static_cast<size_t>(new_height), num_visible_);
+    Layer* below = nullptr;
+    if (height == num_visible_) {
+        below = top_;
+    } else if (height <= num_visible_ / 2) {
+        below = nullptr;
+        for (size_t i = 0; i < height; ++i) {
+            below = below ? below->above_ : bottom_;
+        }
+    } else {
+        below = top_;
+        for (size_t i = num_visible_; i > height; --i) {
+            below = below->below_;
+        }
+    }
+    LinkAbove(layer, below);
 }
 
-void LayerManager::Hide(unsigned int id) {
-    auto layer = FindLayer(id);
-    auto pos = std::find(layer_stack_.begin(), layer_stack_.end(), layer);
+void LayerManager::Raise(unsigned int id) {
+    if (auto layer = FindLayer(id)) {
+        Unlink(layer);
+        LinkAbove(layer, top_);
+    }
+}
 
-    if (pos != layer_stack_.end()) {
-        layer_stack_.erase(pos);
+void LayerManager::Lower(unsigned int id) {
+    if (auto layer = FindLayer(id)) {
+        Unlink(layer);
+        LinkAbove(layer, nullptr);
     }
-}   
+}
 
-Layer* FindLayer(unsigned int id) {
-    auto pred = [id](const std::unique_ptr<Layer>& elem) {
-        return elem -> ID() == id;
-    };
+void LayerManager::Hide(unsigned int id) {
+    if (auto layer = FindLayer(id)) {
+        Unlink(layer);
+    }
+}
 
-    auto it = std::find_if(layers_.begin(), layers_.end(), pred);
-    if (it == layers_.end()) {
+Layer* LayerManager::FindLayer(unsigned int id) {
+    if (id == 0 || id > layers_.size()) {
         return nullptr;
     }
-    return it -> get();
+    return layers_[id - 1].get();
+}
+
+/*
+ * 레이어 ID는 1부터 차례로 발급되고 레이어는 삭제되지 않으므로, 
+ * id 레이어는 항상 layers_[id - 1]에 있다. 따라서 검색 없이 O(1)로 찾을 수 있다.
+ *
+ */
+
+const Layer* LayerManager::FindLayer(unsigned int id) const {
+    return const_cast<LayerManager*>(this)->FindLayer(id);
 }
 
 LayerManager* layer_manager;
\ No newline at end of file
@@ -8,7 +8,6 @@
 
 // sys header
 #include <memory>
-#include <map>
 #include <vector>
 
 // kernel lib
@@ -27,34 +26,90 @@ class Layer {
         Layer& Move(Vector2D<int> pos);
         Layer& MoveRelative(Vector2D<int> pos_diff);
 
-        void DrawTo(PixelWriter& writer) const;
+        Layer& SetOpacity(uint8_t opacity);                // 255: 불투명, 0: 완전히 투명
+        uint8_t Opacity() const;
+
+        Vector2D<int> GetPosition() const;
+        Rectangle<int> Area() const;                        // 레이어가 차지하는 화면 영역 (창이 없으면 빈 영역)
+        bool IsOpaque() const;                              // 영역 안의 모든 픽셀을 덮는지 여부
+
+        void DrawTo(NativePixelWriter& writer) const;
+        void DrawTo(NativePixelWriter& writer, const Rectangle<int>& area) const;
+
+        bool IsVisible() const {  return visible_;  }
 
     private:
         unsigned int id_;
         Vector2D<int> pos_;
         std::shared_ptr<Window> window_;
+        uint8_t opacity_{255};
+
+        // LayerManager가 관리하는 z-order 연결 리스트
+        friend class LayerManager;
+        Layer* below_{nullptr};                             // 바로 아래 레이어
+        Layer* above_{nullptr};                             // 바로 위 레이어
+        bool visible_{false};                               // z-order 리스트에 들어 있는지 여부
 };
 
 class LayerManager {
     public:
-        void SetWriter(PixelWriter* writer);
+        void SetWriter(NativePixelWriter* writer);
         Layer& NewLayer();
 
         void Draw() const;
+        void Draw(const Rectangle<int>& area) const;
+        void Draw(unsigned int id) const;
 
         void Move(unsigned int id, Vector2D<int> new_position);
         void MoveRelative(unsigned int id, Vector2D<int> pos_diff);
 
         void UpDown(unsigned int id, int new_height);
+        void Raise(unsigned int id);
+        void Lower(unsigned int id);
         void Hide(unsigned int id);
 
     private:
-        PixelWriter* writer_{nullptr};
-        std::vector<std::unique_ptr<Layer>> layers_{};
-        std::vector<Layer*> layer_stack_{};
+        NativePixelWriter* writer_{nullptr};
+        std::vector<std::unique_ptr<Layer>> layers_{};      // layers_[id - 1]이 id 레이어이다.
+        Layer* bottom_{nullptr};                            // 가장 아래에 보이는 레이어
+        Layer* top_{nullptr};                               // 가장 위에 보이는 레이어
+        size_t num_visible_{0};
         unsigned int latest_id_{0};
 
+        void Unlink(Layer* layer);
+        void LinkAbove(Layer* layer, Layer* below);
+
         Layer* FindLayer(unsigned int id);
+        const Layer* FindLayer(unsigned int id) const;
+        void DrawArea(const Rectangle<int>& area) const;
+        void DrawBottomUp(const Rectangle<int>& area) const;            // area에 걸친 레이어를 가려진 부분까지 아래부터 모두 그린다.
+        void MoveAndRedraw(Layer* layer, Vector2D<int> new_position);
 };
 
+/**
+ * @brief 레이어를 아래(bottom_)부터 차례로 겹쳐 그리는 컴포지터
+ *
+ * UpDown():
+ *  id 레이어 아래에 new_height개의 레이어가 오도록 옮긴다. new_height가 보이는 레이어 수
+ *  이상이면 가장 위로, 음수이면 숨긴다. 가까운 끝(아래 또는 위)에서부터 찾아가므로 
+ *  O(min(new_height, 보이는 레이어 수 - new_height))이다.
+ *
+ * Raise(), Lower(), Hide():
+ *  레이어를 가장 위로, 가장 아래로 옮기거나 숨긴다. 모두 O(1)이다.
+ *
+ * Draw():
+ *  화면 전체를 다시 그린다.
+ *
+ * Draw(area):
+ *  area 안쪽만 다시 그린다. 각 레이어는 area 중 위의 불투명한 레이어에 
+ *  가려지지 않은 부분만 그려진다.
+ *
+ * Draw(id):
+ *  id 레이어가 차지하는 영역을 다시 그린다. 창의 내용을 바꾼 뒤 호출한다.
+ *
+ * Move(), MoveRelative():
+ *  레이어를 옮기고, 옮기기 전 영역과 옮긴 후 영역만 다시 그린다. 
+ *  따라서 레이어를 옮기는 비용은 화면 크기가 아니라 레이어 크기에 비례한다.
+*/
+
 extern LayerManager* layer_manager;
\ No newline at end of file
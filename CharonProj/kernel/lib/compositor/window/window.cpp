@@ -2,51 +2,143 @@
 
 
 
-Window::Window(int width, int height) : width_{width}, height_{height} {
-    data_.resize(height);
+Window::Window(int width, int height, const NativePixelWriter& format, AlphaMode alpha)
+    : width_{width}, height_{height}, format_{format},
+      alpha_{alpha == AlphaMode::kPremultiplied && format.CanBlend() ? alpha : AlphaMode::kNone},
+      opaque_alpha_{alpha_ == AlphaMode::kPremultiplied ? 0xff000000u : 0u},
+      pixels_(static_cast<size_t>(width) * height) {
+}
 
-    for (int y = 0; y < height; ++y) {
-        data_[y].resize(width);
-    }
+/*
+ * 창의 모든 픽셀을 하나의 연속된 배열에 저장한다. 
+ * 줄마다 따로 할당하던 기존 방식과 달리 힙 할당이 한 번뿐이고, 줄과 줄이 메모리에서 이어진다.
+ *
+ * 픽셀 형식이 8:8:8이 아니라면(format.CanBlend()) 상위 8비트가 색상 채널일 수 있으므로 
+ * kPremultiplied를 사용하지 않고 kNone(불투명)으로 만든다.
+ *
+ */
+
+void Window::DrawTo(NativePixelWriter& writer, Vector2D<int> position) {
+    DrawTo(writer, position, {position, {Width(), Height()}});
 }
 
-void Window::DrawTo(PixelWriter& writer, Vector2D<int> position) {
-    if (!transparent_color_) {
-        for (int y = 0; y < Height(); ++y) {
-            for (int x = 0; x < Width(); ++x) {
-                writer.Write(position.x + x, position.y + y, At(x, y));
-            }
-        }
+void Window::DrawTo(
+    NativePixelWriter& writer, Vector2D<int> position,
+    const Rectangle<int>& area, uint8_t opacity
+) {
+    const Rectangle<int> window_area{position, {Width(), Height()}};
+    const auto target = window_area & area & writer.ClipRect();    // 1)
+    if (target.IsEmpty() || opacity == 0) {
         return;
     }
+    if (!writer.CanBlend()) {
+        opacity = 255;
+    }
 
-    const auto transcolor = transparent_color_.value();
+    const int x0 = target.pos.x - position.x;                       // 2)
+    const int y0 = target.pos.y - position.y;
 
-    for (int y = 0; y < Height(); ++y) {
-        for (int x = 0; x < Width(); ++x) {
-            const auto color = At(x, y);
+    if (alpha_ == AlphaMode::kPremultiplied) {                      // 3)
+        writer.BlendRect32(target.pos, target.size, RowAt(x0, y0), width_, opacity, true);
+        return;
+    }
 
-            if (color != transcolor) {
-                writer.Write(position.x + x, position.y + y, color);
-            }
+    if (!transparent_color_) {                                      // 4)
+        if (opacity == 255) {
+            writer.WriteRect32(target.pos, target.size, RowAt(x0, y0), width_);
+        } else {
+            writer.BlendRect32(target.pos, target.size, RowAt(x0, y0), width_, opacity, false);
         }
+        return;
+    }
+
+    if (opacity == 255) {                                           // 5)
+        writer.WriteRect32ColorKey(target.pos, target.size, RowAt(x0, y0), width_, transparent_key_);
+        return;
+    }
+
+    uint32_t* row = row_buffer_.data();                             // 6)
+    for (int dy = 0; dy < target.size.y; ++dy) {
+        const uint32_t* src = RowAt(x0, y0 + dy);
+        for (int dx = 0; dx < target.size.x; ++dx) {
+            row[dx] = src[dx] == transparent_key_ ? 0 : (src[dx] | 0xff000000u);
+        }
+        writer.BlendRect32(
+            {target.pos.x, target.pos.y + dy}, {target.size.x, 1}, row, target.size.x, opacity, true
+        );
     }
 }
 
+/*
+ * 창 중 area와 겹치는 부분만 그린다.
+ *
+ * 동작방식:
+ * 	1) 창이 차지하는 화면 영역과 area, writer의 clip 영역의 교집합을 구한다. 
+ * 	   겹치지 않으면(화면 밖의 창 등) 줄 변환 없이 바로 돌아간다. 
+ * 	   writer가 섞을 수 없는 형식이라면(CanBlend()) 레이어 불투명도를 무시하고 불투명하게 그린다.
+ * 	2) 교집합의 왼쪽 위 모서리를 창 안의 좌표(x0, y0)로 바꾼다.
+ * 	3) 픽셀마다 알파를 가진 창은 BlendRect32()로 아래 픽셀과 섞는다. 
+ * 	4) 불투명한 창은 변환 없이 줄 단위로 복사하고, 레이어 불투명도가 있다면 알파를 255로 보고 섞는다.
+ * 	5) 투명색이 있다면 Encode()로 변환해둔 투명색과 같은 픽셀은 건너뛴다. 
+ * 	   (CopyPixels32(), CopyPixels32ColorKey(), BlendPixels32()가 SIMD로 처리한다)
+ * 	6) 투명색과 레이어 불투명도를 함께 사용한다면, 한 줄씩 투명색을 알파 0으로, 나머지를 
+ * 	   알파 255로 바꾼 뒤 섞는다. 줄은 SetTransparentColor()에서 한 번 할당해둔 row_buffer_에 만든다.
+ *
+ */
+
 void Window::SetTransparentColor(std::optional<PixelColor> c) {
     transparent_color_ = c;
+    if (c) {
+        transparent_key_ = format_.Encode(*c) | opaque_alpha_;
+        row_buffer_.resize(width_);
+    }
+}
+
+bool Window::IsOpaque() const {
+    return !transparent_color_ && alpha_ == AlphaMode::kNone;
 }
 
 Window::WindowPainter* Window::Painter() {
     return &painter_;
 }
 
-PixelColor& Window::At(int x, int y) {
-    return data_[y][x];
+void Window::Write(int x, int y, const PixelColor& c) {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+        return;
+    }
+    pixels_[width_ * y + x] = format_.Encode(c) | opaque_alpha_;
+}
+
+void Window::WriteAlpha(int x, int y, const PixelColor& c, uint8_t alpha) {
+    if (alpha_ == AlphaMode::kNone) {
+        Write(x, y, c);
+        return;
+    }
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+        return;
+    }
+
+    auto premultiply = [alpha](uint8_t v) {
+        return static_cast<uint8_t>((v * alpha + 127) / 255);
+    };
+    const PixelColor premultiplied{premultiply(c.r), premultiply(c.g), premultiply(c.b)};
+    pixels_[width_ * y + x] = format_.Encode(premultiplied) | (static_cast<uint32_t>(alpha) << 24);
+}
+
+void Window::FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, width_, height_)) {
+        return;
+    }
+
+    const uint32_t value = format_.Encode(c) | opaque_alpha_;
+    for (int dy = 0; dy < s.y; ++dy) {
+        FillPixels32(&pixels_[width_ * (p.y + dy) + p.x], value, s.x);
+    }
 }
 
-const PixelColor& Window::At(int x, int y) const {
-    return data_[y][x];
+const uint32_t* Window::RowAt(int x, int y) const {
+    return &pixels_[width_ * y + x];
 }
 
 int Window::Width() const {
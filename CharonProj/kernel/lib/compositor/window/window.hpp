@@ -19,7 +19,24 @@ class Window {
             public:
                 WindowPainter(Window& window) : window_{window} {}
                 virtual void Write(int x, int y, const PixelColor& c) override {
-                    window_.At(x, y) = c;
+                    if (ClipRect().Contains(Vector2D<int>{x, y})) {
+                        window_.Write(x, y, c);
+                    }
+                }
+
+                virtual void WriteUnclipped(int x, int y, const PixelColor& c) override {
+                    window_.Write(x, y, c);
+                }
+
+                virtual void FillSpan(int x, int y, int length, const PixelColor& c) override {
+                    FillRect({x, y}, {length, 1}, c);
+                }
+
+                virtual void FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c) override {
+                    const Rectangle<int> area = Rectangle<int>{pos, size} & ClipRect();
+                    if (!area.IsEmpty()) {
+                        window_.FillRect(area.pos, area.size, c);
+                    }
                 }
 
                 virtual int Width() const override {  return window_.Width();  }
@@ -29,26 +46,42 @@ class Window {
                 Window& window_;
         };
 
-        Window(int width, int height);
+        enum class AlphaMode {
+            kNone,                          // 모든 픽셀이 불투명하다.
+            kPremultiplied,                 // 픽셀마다 premultiplied alpha를 가진다. (ARGB)
+        };
+
+        Window(int width, int height, const NativePixelWriter& format, AlphaMode alpha = AlphaMode::kNone);
         ~Window() = default;
         Window(const Window& rhs) = delete;
         Window& operator=(const Window& rhs) = delete;
 
-        void DrawTo(PixelWriter& writer, Vector2D<int> position);
+        void DrawTo(NativePixelWriter& writer, Vector2D<int> position);
+        void DrawTo(
+            NativePixelWriter& writer, Vector2D<int> position,
+            const Rectangle<int>& area, uint8_t opacity = 255
+        );
         /**
-         * @brief 
+         * @brief 창을 position 위치에 그린다.
+         * 
+         * @param writer 창을 그릴 NativePixelWriter. 창을 만들 때 넘긴 format과 같은 형식이어야 한다.
          * 
-         * @param writer
+         * @param position 창의 왼쪽 위 모서리가 놓일 화면 좌표
          * 
-         * @param position
+         * @param area 화면 좌표로 주어지는 그리기 영역. 창 중 이 영역과 겹치는 부분만 그린다.
+         *             생략하면 창 전체를 그린다.
          * 
+         * @param opacity 창 전체에 곱해지는 불투명도. 255이면 창의 픽셀을 그대로 그린다.
         */
 
        void SetTransparentColor(std::optional<PixelColor> c);
+       bool IsOpaque() const;
        WindowPainter* Painter();
 
-       PixelColor& At(int x, int y);
-       const PixelColor& At(int x, int y) const;
+       void Write(int x, int y, const PixelColor& c);
+       void WriteAlpha(int x, int y, const PixelColor& c, uint8_t alpha);
+       void FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c);
+       const uint32_t* RowAt(int x, int y) const;
 
        int Width() const;
        int Height() const;
@@ -57,8 +90,44 @@ class Window {
     private:
         int width_;
         int height_;
+        const NativePixelWriter& format_;
+        const AlphaMode alpha_;
+        const uint32_t opaque_alpha_;                   // 불투명한 픽셀의 상위 8비트 (kPremultiplied일 때 0xff)
 
-        std::vector<std::vector<PixelColor>> data_{};
+        std::vector<uint32_t> pixels_{};
         std::optional<PixelColor> transparent_color_{std::nullopt};
+        uint32_t transparent_key_{0};
+        std::vector<uint32_t> row_buffer_{};            // 투명색 + 레이어 불투명도로 그릴 때 한 줄을 변환하는 버퍼 (width_ 픽셀)
         WindowPainter painter_{*this};
 }; 
+
+/**
+ * 창의 픽셀은 width * height 크기의 연속된 배열 하나에, format(보통 BackBuffer 또는 
+ * 프레임 버퍼 작성자)의 Encode()로 변환된 32비트 값으로 저장된다.
+ *
+ * Write(), FillRect():
+ *  창 안의 좌표에 색을 쓴다. 창 밖의 좌표는 무시된다.
+ *
+ * Painter():
+ *  창에 그리는 PixelWriter를 반환한다. PushClip()으로 창 안의 일부(제목 표시줄, 내용 영역 등)만 
+ *  그리도록 제한할 수 있으며, FillRect()는 clip 영역과 한 번 교차한 뒤 창에 채운다.
+ *
+ * WriteAlpha():
+ *  알파를 곱하지 않은 색과 알파를 받아 premultiplied alpha로 저장한다. 
+ *  AlphaMode::kNone인 창에서는 Write()와 같다.
+ *
+ * RowAt():
+ *  (x, y) 픽셀의 주소를 반환한다. 한 줄은 Width()개의 픽셀로 이루어진다.
+ *
+ * AlphaMode::kPremultiplied:
+ *  각 픽셀의 상위 8비트에 알파를 저장하고, 색상 채널에는 미리 알파를 곱해둔다. 
+ *  그림자, 반투명한 터미널, 안티에일리어싱된 가장자리를 한 번의 합성으로 그릴 수 있다.
+ *  format이 8:8:8 형식이 아니라면(NativePixelWriter::CanBlend()) 상위 비트가 색상 채널일 수 있으므로 
+ *  kNone으로 만들어지며, WriteAlpha()는 Write()와 같아진다.
+ *
+ * PLUS:
+ *  미리 변환된 형식으로 저장하는 이유:
+ *      창을 그리는 일은 창을 수정하는 일보다 훨씬 자주 일어난다. (다른 창이나 마우스가 
+ *      지나갈 때마다 다시 그린다) 픽셀을 쓸 때 한 번 변환해두면, 그릴 때는 줄마다 
+ *      메모리 복사 한 번으로 끝나 메모리 대역폭만큼의 속도로 합성할 수 있다.
+*/
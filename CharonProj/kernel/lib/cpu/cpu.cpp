@@ -0,0 +1,116 @@
+/**
+ * @file cpu.cpp
+*/
+
+#include "cpu.hpp"
+
+
+namespace {
+    CPUFeatures cpu_features{};
+
+    // CR0
+    const uint64_t kCR0MonitorCoprocessor = 1u << 1;    // MP
+    const uint64_t kCR0Emulation          = 1u << 2;    // EM
+    const uint64_t kCR0TaskSwitched       = 1u << 3;    // TS
+
+    // CR4
+    const uint64_t kCR4OSFXSR             = 1u << 9;    // FXSAVE/FXRSTOR, SSE 명령어 허용
+    const uint64_t kCR4OSXMMEXCPT         = 1u << 10;   // SIMD 부동소수점 예외(#XM) 허용
+    const uint64_t kCR4OSXSAVE            = 1u << 18;   // XSAVE, XGETBV/XSETBV 허용
+
+    // XCR0
+    const uint64_t kXCR0X87               = 1u << 0;
+    const uint64_t kXCR0SSE               = 1u << 1;
+    const uint64_t kXCR0AVX               = 1u << 2;
+
+    bool Bit(uint32_t reg, int bit) {
+        return (reg >> bit) & 1u;
+    }
+}
+
+
+void InitializeCPUFeatures() {
+    uint32_t regs[4];                                   // eax, ebx, ecx, edx
+
+    CPUID(0, 0, regs);                                  // 1)
+    const uint32_t max_leaf = regs[0];
+
+    CPUID(1, 0, regs);
+    cpu_features.sse2  = Bit(regs[3], 26);
+    cpu_features.sse41 = Bit(regs[2], 19);
+    cpu_features.xsave = Bit(regs[2], 26);
+    const bool cpu_avx = Bit(regs[2], 28);
+
+    bool cpu_avx2 = false;
+    if (max_leaf >= 7) {
+        CPUID(7, 0, regs);
+        cpu_avx2           = Bit(regs[1], 5);
+        cpu_features.erms  = Bit(regs[1], 9);
+    }
+
+    uint64_t cr0 = GetCR0();                            // 2)
+    cr0 &= ~(kCR0Emulation | kCR0TaskSwitched);
+    cr0 |= kCR0MonitorCoprocessor;
+    SetCR0(cr0);
+
+    uint64_t cr4 = GetCR4();                            // 3)
+    cr4 |= kCR4OSFXSR | kCR4OSXMMEXCPT;
+    if (cpu_features.xsave) {
+        cr4 |= kCR4OSXSAVE;
+    }
+    SetCR4(cr4);
+
+    if (cpu_features.xsave) {                           // 4)
+        uint64_t xcr0 = kXCR0X87 | kXCR0SSE;
+        if (cpu_avx) {
+            xcr0 |= kXCR0AVX;
+        }
+        XSetBV(0, xcr0);
+
+        cpu_features.xcr0 = XGetBV(0);
+        CPUID(0xd, 0, regs);
+        cpu_features.xsave_size = regs[1];
+    } else {
+        cpu_features.xcr0 = 0;
+        cpu_features.xsave_size = 512;                  // FXSAVE 영역의 크기
+    }
+
+    const uint64_t ymm_state = kXCR0SSE | kXCR0AVX;     // 5)
+    cpu_features.avx  = cpu_avx && (cpu_features.xcr0 & ymm_state) == ymm_state;
+    cpu_features.avx2 = cpu_avx2 && cpu_features.avx;
+}
+
+/**
+ * @brief CPU 기능을 확인하고 SSE/AVX 상태를 활성화한다.
+ *
+ * 동작방식:
+ *  1) CPUID 0, 1, 7번 leaf에서 필요한 기능 비트를 읽는다.
+ *
+ *  2) CR0.EM을 지우고 CR0.MP를 세운다. EM이 세워져 있으면 SSE 명령어가 #UD를 일으킨다.
+ *     TS도 지워서 첫 SSE 명령어에서 #NM이 발생하지 않게 한다.
+ *
+ *  3) CR4.OSFXSR, CR4.OSXMMEXCPT를 세워 OS가 FXSAVE로 SSE 상태를 저장할 수 있음을 알리고,
+ *     XSAVE를 지원한다면 CR4.OSXSAVE를 세워 XSETBV를 사용할 수 있게 한다.
+ *
+ *  4) XCR0에 x87, SSE 상태와 (지원한다면) AVX 상태를 활성화한다. 이후 XSAVE 영역의 
+ *     크기를 CPUID 0xd번 leaf에서 읽어둔다.
+ *
+ *  5) CPU가 AVX를 지원하고 XCR0에 SSE, AVX 상태가 모두 켜진 경우에만 AVX/AVX2를 사용 가능으로 표시한다.
+ *
+ * PLUS:
+ *  인터럽트와 SIMD 레지스터:
+ *      커널은 -mno-red-zone으로 빌드되며, __attribute__((interrupt)) 핸들러는 컴파일러가 
+ *      핸들러 안에서 사용하는 모든 레지스터(XMM 포함)를 직접 저장하고 복원한다. 핸들러와 
+ *      핸들러가 호출하는 함수들은 AVX 없이 빌드되므로 YMM의 상위 128비트를 건드리지 않는다.
+ *      따라서 AVX2 코드가 실행되는 도중에 인터럽트가 발생해도 상태가 깨지지 않는다.
+ *
+ *  태스크 전환:
+ *      아직 커널에는 태스크 전환이 없다. 태스크 전환을 추가할 때에는 태스크마다 
+ *      xsave_size 바이트(64바이트 정렬)의 영역을 두고, xsave가 true라면 XSAVE/XRSTOR를,
+ *      그렇지 않다면 FXSAVE/FXRSTOR를 사용하여 SIMD 상태를 저장, 복원해야 한다.
+*/
+
+
+const CPUFeatures& GetCPUFeatures() {
+    return cpu_features;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file cpu.hpp
+ *
+ * CPUID로 CPU가 지원하는 기능을 확인하고, 커널에서 SSE/AVX를 사용할 수 있도록 
+ * 제어 레지스터를 설정한다.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include "cpu_asm.h"
+
+
+struct CPUFeatures {
+    bool sse2;              // CPUID.1:EDX[26]
+    bool sse41;             // CPUID.1:ECX[19]
+    bool xsave;             // CPUID.1:ECX[26], XSAVE/XRSTOR/XSETBV 명령어 지원
+    bool avx;               // CPUID.1:ECX[28]이며, OS가 YMM 상태를 활성화한 경우에만 true
+    bool avx2;              // CPUID.7.0:EBX[5]이며, avx가 true인 경우에만 true
+    bool erms;              // CPUID.7.0:EBX[9], 빠른 rep movsb/stosb 지원
+    uint64_t xcr0;          // 활성화된 XSAVE 상태 구성요소
+    uint32_t xsave_size;    // 활성화된 상태를 모두 저장하는 데 필요한 XSAVE 영역의 크기
+};
+
+/**
+ * @brief CPU가 지원하며 커널에서 실제로 사용할 수 있는 기능
+ *
+ * avx, avx2는 CPU가 지원하더라도 XCR0에 YMM 상태가 활성화되지 않았다면 false가 된다.
+ * 따라서 SIMD 코드는 CPUID를 직접 확인하지 않고 이 구조체만 확인해야 한다.
+*/
+
+
+void InitializeCPUFeatures();
+/**
+ * @brief CPU 기능을 확인하고 SSE/AVX 상태를 활성화한다.
+ *
+ * 부팅 직후 가장 먼저 호출한다. 자세한 동작방식은 cpu.cpp에 작성되어 있다.
+*/
+
+const CPUFeatures& GetCPUFeatures();
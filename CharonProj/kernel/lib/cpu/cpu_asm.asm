@@ -0,0 +1,58 @@
+; cpu_asm.asm
+;
+; System V AMD64 Calling Convention
+; Registers: RDI, RSI, RDX, RCX, R8, R9
+
+bits 64
+section .text
+
+global CPUID                ; void CPUID(uint32_t leaf, uint32_t subleaf, uint32_t* regs)
+CPUID:
+    push rbx                ; rbx는 callee-saved 레지스터이다.
+    mov r8, rdx
+    mov eax, edi
+    mov ecx, esi
+    cpuid
+    mov [r8], eax
+    mov [r8 + 4], ebx
+    mov [r8 + 8], ecx
+    mov [r8 + 12], edx
+    pop rbx
+    ret
+
+global GetCR0               ; uint64_t GetCR0(void)
+GetCR0:
+    mov rax, cr0
+    ret
+
+global SetCR0               ; void SetCR0(uint64_t value)
+SetCR0:
+    mov cr0, rdi
+    ret
+
+global GetCR4               ; uint64_t GetCR4(void)
+GetCR4:
+    mov rax, cr4
+    ret
+
+global SetCR4               ; void SetCR4(uint64_t value)
+SetCR4:
+    mov cr4, rdi
+    ret
+
+global XGetBV               ; uint64_t XGetBV(uint32_t index)
+XGetBV:
+    mov ecx, edi
+    xgetbv                  ; EDX:EAX <- XCR[ECX]
+    shl rdx, 32
+    or rax, rdx
+    ret
+
+global XSetBV               ; void XSetBV(uint32_t index, uint64_t value)
+XSetBV:
+    mov ecx, edi
+    mov eax, esi
+    mov rdx, rsi
+    shr rdx, 32
+    xsetbv                  ; XCR[ECX] <- EDX:EAX
+    ret
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+extern "C" {
+    void CPUID(uint32_t leaf, uint32_t subleaf, uint32_t* regs);
+    uint64_t GetCR0(void);
+    void SetCR0(uint64_t value);
+    uint64_t GetCR4(void);
+    void SetCR4(uint64_t value);
+    uint64_t XGetBV(uint32_t index);
+    void XSetBV(uint32_t index, uint64_t value);
+}
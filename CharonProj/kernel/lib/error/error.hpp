@@ -31,9 +31,12 @@ class Error {
             kUnknownXHCISpeedID, 			// 알 수 없는 XHCI속도 ID
             kNoWaiter, 					// 대기열이 없을 경우 반환
             kNoPCIMSI,
+            kNoFreeInterruptVector, 			// 할당 가능한 인터럽트 벡터가 남아있지 않을 경우 반환
+            kNoSerialPort, 				// 시리얼 포트(UART)가 없거나 루프백 검사에 응답하지 않을 경우 반환
+            kInvalidFont, 				// 폰트(글리프 아틀라스)의 형식이 올바르지 않을 경우 반환
             kLastOfCode, 				// 코드 목록의 마지막을 의미
         };
-        // 22
+        // 25
 
     private:
         static constexpr std::array code_names_{ 	// code_name_이라는 이름의 array선언 후 오류 코드들의 문자열을 초기화
@@ -58,7 +61,10 @@ class Error {
             "kUnknownXHCISpeedID",
             "kNoWaiter",
             "kNoPCIMSI",
-            //22
+            "kNoFreeInterruptVector",
+            "kNoSerialPort",
+            "kInvalidFont",
+            //25
         };
 
         static_assert(Error::Code::kLastOfCode == code_names_.size()); 		// Error::Code::kLastOfCode의 값이 code_name_의 크기와 같은지 확인 후 불일치 시 컴파일 오류 생성
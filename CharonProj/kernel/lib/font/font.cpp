@@ -2,7 +2,10 @@
  * @file font.cpp
 */
 
+#include <cstring>
+
 #include "font.hpp"
+#include "../graphics/pixel_ops.hpp"
 
 extern const uint8_t _binary_kernelFont_bin_start;  						// kernelFont 바이너리의 start 포인트를 불러온다.
 extern const uint8_t _binary_kernelFont_bin_end; 						// kernelFont 바이너리의 end   포인트를 불러온다.
@@ -61,11 +64,15 @@ void WriteAscii(PixelWriter& writer, int x, int y, char f, const PixelColor& col
     if (font == nullptr) { 									// 2)
         return;
     }
+    const auto visible = Rectangle<int>{{x, y}, {8, 16}} & writer.ClipRect();
+    if (visible.IsEmpty()) {
+        return;
+    }
 
-    for (int dy = 0; dy < 16; ++dy) { 								// 3)
-        for (int dx = 0; dx < 8; ++dx) {  							// 4)
+    for (int dy = visible.pos.y - y; dy < visible.pos.y + visible.size.y - y; ++dy) { 		// 3)
+        for (int dx = visible.pos.x - x; dx < visible.pos.x + visible.size.x - x; ++dx) {  	// 4)
             if ((font[dy] << dx) & 0x80u) { 							// 5)
-            writer.Write(x + dx, y + dy, color); 					// 6)
+            writer.WriteUnclipped(x + dx, y + dy, color); 				// 6)
           }
       }
     }
@@ -79,14 +86,17 @@ void WriteAscii(PixelWriter& writer, int x, int y, char f, const PixelColor& col
  * 	1) FetchFont함수를 사용해서 문자 f에 해당하는 폰트 데이터를 가져온다.
  *
  * 	2) 만약 font변수의 값이 nullptr이라면(FetchFont에서 폰트 데이터의 범위를 벗어난 경우) 함수를 종료한다.
+ * 	   글자가 writer의 clip 영역과 겹치지 않는 경우에도 바로 종료한다.
  *
  * 	3) 높이에 대한 반복문을 시작한다. 폰트는 16x8 크기의 픽셀 배열로 표시되므로 높이에 대한 루프의 최대는 16으로 제한된다.
  *
  * 	4) 너비에 대한 반복문을 시작한다. 폰트의 너비는 8픽셀이므로 너비에 대한 루프의 최대는 8로 제한된다.
+ * 	   3), 4)의 범위는 글자 중 clip 영역 안에 있는 부분으로 미리 한 번 줄여둔다.
  *
  * 	5) 현재의 폰트 데이터를 가져와서 'dx'만큼 비트를 이동하고, 비트의 값이 1이라면 해당 위치에 writer.Write 함수가 실행된다.
  *
- * 	6) PixelWriter 클래스의 Write함수를 이용해서 주어진 위치(x + dx, y + dy)에 픽셀을 그린다.
+ * 	6) PixelWriter 클래스의 WriteUnclipped함수를 이용해서 주어진 위치(x + dx, y + dy)에 픽셀을 그린다.
+ * 	   3), 4)의 범위가 이미 clip 영역 안이므로 픽셀마다 ClipRect()를 다시 검사하지 않는다.
  *
  *
  * PLUS:
@@ -123,3 +133,361 @@ void print_str(PixelWriter& writer, int x, int y, const char* s, const PixelColo
  *
  * */
 
+
+
+
+
+
+
+void GlyphCache::Build(const NativePixelWriter& format, const PixelColor& fg, const PixelColor* bg) {
+    const uint32_t fg_value = format.Encode(fg); 						// 1)
+    const uint32_t bg_value = bg ? format.Encode(*bg) : kTransparentKey;
+    opaque_ = bg != nullptr;
+    blend_ = format.CanBlend();
+    fg_value_ = fg_value;
+    bg_value_ = bg_value;
+    for (auto& codepoint : slot_codepoints_) {
+        codepoint = kWideTail;
+    }
+    expandAscii();
+}
+
+void GlyphCache::expandAscii() {
+    const auto font_size = reinterpret_cast<uintptr_t>(&_binary_kernelFont_bin_size);
+    for (int g = 0; g < kNumGlyphs; ++g) { 							// 2)
+        uint32_t* glyph = glyphs_[g];
+        const uintptr_t index = kGlyphHeight * g;
+
+        for (int dy = 0; dy < kGlyphHeight; ++dy) {
+            const uint8_t bits = index < font_size ? (&_binary_kernelFont_bin_start)[index + dy] : 0;
+            for (int dx = 0; dx < kGlyphWidth; ++dx) { 						// 3)
+                glyph[kGlyphWidth * dy + dx] = ((bits << dx) & 0x80u) ? fg_value_ : bg_value_;
+            }
+        }
+    }
+
+    if (!font_ || !font_->HasCoverage()) { 							// 4)
+        return;
+    }
+    for (char32_t c = 0x20; c < 0x80; ++c) {
+        const FontAtlasEntry* entry = font_->Find(c);
+        if (entry && entry->Width() <= kGlyphWidth) {
+            expand(font_->GlyphOf(*entry), glyphs_[c], kGlyphWidth);
+        }
+    }
+}
+
+/*
+ * 글리프 캐시를 (다시) 만드는 함수이다.
+ *
+ * 동작방식:
+ * 	1) 전경색과 배경색을 한 번만 프레임 버퍼 형식의 32비트 값으로 변환한다.
+ *
+ * 	2) 폰트 데이터의 모든 글리프(256개)에 대해 반복한다. 폰트 데이터 범위를 벗어나는 글리프는 빈 글리프가 된다.
+ *
+ * 	3) WriteAscii()와 같은 방법으로 비트를 검사하여, 켜진 비트는 전경색, 꺼진 비트는 배경색으로 채운다.
+ *
+ * 	4) 안티에일리어싱된(커버리지) 유니코드 폰트가 설정되어 있다면, 폰트에 있는 아스키 글리프로 덮어쓴다.
+ * 	   아스키 글자도 같은 폰트로 그려야 글자의 모양과 굵기가 섞이지 않는다.
+ *
+ * 색상이 바뀌었으므로 아스키가 아닌 글리프의 슬롯도 모두 비운다. (다음에 그릴 때 다시 펼친다)
+ *
+ * */
+
+
+
+
+
+
+void GlyphCache::WriteAscii(NativePixelWriter& writer, int x, int y, char c) const {
+    if (opaque_) {
+        writer.WriteRect32({x, y}, {kGlyphWidth, kGlyphHeight}, Glyph(c), kGlyphWidth);
+    } else {
+        writer.WriteRect32ColorKey({x, y}, {kGlyphWidth, kGlyphHeight}, Glyph(c), kGlyphWidth, kTransparentKey);
+    }
+}
+
+void GlyphCache::WriteString(NativePixelWriter& writer, int x, int y, const char* s, int length) {
+    if (!opaque_) {
+        for (int i = 0; i < length; ++i) {
+            WriteAscii(writer, x + kGlyphWidth * i, y, s[i]);
+        }
+        return;
+    }
+
+    const Rectangle<int> clip = writer.ClipRect();
+    while (length > 0) {
+        const int n = length < kStripChars ? length : kStripChars; 				// 1)
+        const int stride = kGlyphWidth * n;
+        if ((Rectangle<int>{{x, y}, {stride, kGlyphHeight}} & clip).IsEmpty()) {
+            x += stride;
+            s += n;
+            length -= n;
+            continue;
+        }
+
+        for (int i = 0; i < n; ++i) { 								// 2)
+            const uint32_t* glyph = Glyph(s[i]);
+            for (int dy = 0; dy < kGlyphHeight; ++dy) {
+                memcpy(&strip_[stride * dy + kGlyphWidth * i], &glyph[kGlyphWidth * dy], 
+                       sizeof(uint32_t) * kGlyphWidth);
+            }
+        }
+        writer.WriteRect32({x, y}, {stride, kGlyphHeight}, strip_, stride); 			// 3)
+
+        x += stride;
+        s += n;
+        length -= n;
+    }
+}
+
+/*
+ * 미리 그려둔 글리프를 writer에 복사하는 함수이다.
+ *
+ * WriteString()의 동작방식 (불투명한 경우):
+ * 	1) 최대 kStripChars개의 글자를 한 덩어리(strip)로 처리한다. 
+ * 	   덩어리가 writer의 clip 영역 밖에 있다면 strip을 만들지 않고 건너뛴다.
+ *
+ * 	2) 각 글리프의 행(8픽셀, 32바이트)을 strip_의 같은 행에 가로로 이어 붙인다.
+ *
+ * 	3) 완성된 strip을 한 번의 WriteRect32()로 복사한다. 한 줄의 글자가 
+ * 	   16개의 연속된 행으로 복사되므로 글자마다 가상 함수를 호출하지 않아도 된다.
+ *
+ * */
+
+
+
+
+
+
+void GlyphCache::SetFont(const UnicodeFont* font) {
+    font_ = font && font->Height() == kGlyphHeight ? font : nullptr;
+    for (auto& codepoint : slot_codepoints_) {
+        codepoint = kWideTail;
+    }
+    expandAscii();
+}
+
+int GlyphCache::Cells(char32_t c) {
+    return c < 0x80 ? 1 : lookup(c).cells;
+}
+
+GlyphCache::Expanded GlyphCache::lookup(char32_t c) {
+    if (c < 0x80) { 										// 1)
+        return {glyphs_[c], 1};
+    }
+
+    const uint32_t slot = (c * 0x9e3779b1u) >> 25; 						// 2)
+    static_assert(kNumSlots == 1 << (32 - 25));
+    if (slot_codepoints_[slot] == c) {
+        return {slots_[slot], slot_cells_[slot]};
+    }
+
+    const FontAtlasEntry* entry = nullptr; 							// 3)
+    if (font_) {
+        entry = font_->Find(c);
+        if (!entry) {
+            entry = font_->Find(UnicodeFont::kReplacementCharacter);
+        }
+    }
+    if (!entry) {
+        return {glyphs_['?'], 1};
+    }
+
+    const auto glyph = font_->GlyphOf(*entry); 						// 4)
+    const int cells = glyph.width > kGlyphWidth ? 2 : 1;
+    uint32_t* pixels = slots_[slot];
+    expand(glyph, pixels, kGlyphWidth * cells);
+    slot_codepoints_[slot] = c;
+    slot_cells_[slot] = cells;
+    return {pixels, cells};
+}
+
+/*
+ * 글자에 해당하는 펼쳐진 글리프를 찾는 함수이다.
+ *
+ * 동작방식:
+ * 	1) 아스키 문자는 Build()에서 펼쳐둔 glyphs_를 그대로 사용한다.
+ *
+ * 	2) 그 외의 글자는 코드 포인트의 해시로 슬롯을 정하고, 슬롯에 같은 글자가 있다면 그대로 사용한다.
+ *
+ * 	3) 없다면 폰트에서 글리프를 찾는다. 폰트에 없는 글자는 U+FFFD로, 폰트가 없다면 '?'로 대신한다.
+ *
+ * 	4) 글리프의 비트맵을 슬롯에 펼친다. 8픽셀보다 넓은 글리프는 16픽셀 폭(두 칸)으로 펼치며,
+ * 	   글리프의 폭을 넘는 부분은 배경색(또는 투명)으로 채운다. 슬롯을 쓰던 다른 글자는 밀려난다.
+ *
+ * */
+
+
+
+void GlyphCache::expand(const UnicodeFont::Glyph& glyph, uint32_t* pixels, int stride) const {
+    const int width = glyph.width < stride ? glyph.width : stride;
+
+    for (int dy = 0; dy < kGlyphHeight; ++dy) {
+        uint32_t* row = pixels + stride * dy;
+        if (glyph.coverage && opaque_ && blend_) { 						// 1)
+            LerpPixels32(row, glyph.bitmap + glyph.bytes_per_row * dy, width, fg_value_, bg_value_);
+        } else {
+            for (int dx = 0; dx < width; ++dx) { 						// 2)
+                row[dx] = glyph.Coverage(dx, dy) >= 128 ? fg_value_ : bg_value_;
+            }
+        }
+        for (int dx = width; dx < stride; ++dx) {
+            row[dx] = bg_value_;
+        }
+    }
+}
+
+/*
+ * 유니코드 폰트의 글리프 하나를 stride 픽셀 폭의 배열에 펼치는 함수이다.
+ *
+ * 동작방식:
+ * 	1) 커버리지 글리프이고 배경색을 알고 있으며(불투명) 픽셀 형식이 8:8:8이라면, 행마다 LerpPixels32()로 전경색과 배경색을 
+ * 	   커버리지만큼 섞는다. 섞은 결과가 (글리프, 전경색, 배경색)마다 캐시되므로, 이후의 비용은
+ * 	   1비트 폰트와 같이 펼쳐진 픽셀을 복사하는 것뿐이다.
+ *
+ * 	2) 1비트 글리프이거나, 투명한 캐시라서 섞을 배경을 모르거나, 채널을 섞을 수 없는 형식이라면 커버리지의 절반을 기준으로 
+ * 	   전경색 또는 배경색(투명)을 고른다.
+ *
+ * */
+
+
+
+void GlyphCache::writeCell(
+    NativePixelWriter& writer, int x, int y, const uint32_t* pixels, int cells, int stride
+) const {
+    if (opaque_) {
+        writer.WriteRect32({x, y}, {kGlyphWidth * cells, kGlyphHeight}, pixels, stride);
+    } else {
+        writer.WriteRect32ColorKey({x, y}, {kGlyphWidth * cells, kGlyphHeight}, pixels, stride, kTransparentKey);
+    }
+}
+
+void GlyphCache::WriteCells(NativePixelWriter& writer, int x, int y, const char32_t* cells, int length) {
+    const Rectangle<int> clip = writer.ClipRect();
+    while (length > 0) {
+        int n = length < kStripChars ? length : kStripChars; 				// 1)
+        if (n < length && cells[n] == kWideTail) {
+            --n;
+        }
+        const int stride = kGlyphWidth * n;
+        if ((Rectangle<int>{{x, y}, {stride, kGlyphHeight}} & clip).IsEmpty()) {
+            x += stride;
+            cells += n;
+            length -= n;
+            continue;
+        }
+
+        for (int i = 0; i < n; ) {
+            Expanded glyph = cells[i] == kWideTail                                  	// 2)
+                ? Expanded{glyphs_[' '], 1} : lookup(cells[i]);
+            const int glyph_stride = kGlyphWidth * glyph.cells;
+            const int drawn = glyph.cells == 2 && i + 1 < n && cells[i + 1] == kWideTail ? 2 : 1;
+
+            if (opaque_) { 									// 3)
+                for (int dy = 0; dy < kGlyphHeight; ++dy) {
+                    memcpy(&strip_[stride * dy + kGlyphWidth * i], &glyph.pixels[glyph_stride * dy],
+                           sizeof(uint32_t) * kGlyphWidth * drawn);
+                }
+            } else {
+                writeCell(writer, x + kGlyphWidth * i, y, glyph.pixels, drawn, glyph_stride);
+            }
+            i += drawn;
+        }
+        if (opaque_) {
+            writer.WriteRect32({x, y}, {stride, kGlyphHeight}, strip_, stride);
+        }
+
+        x += stride;
+        cells += n;
+        length -= n;
+    }
+}
+
+/*
+ * 터미널의 칸(코드 포인트)들을 그리는 함수이다.
+ *
+ * 동작방식:
+ * 	1) 최대 kStripChars칸을 한 덩어리로 처리하되, 두 칸 글자가 덩어리의 경계에서 나뉘지 않도록
+ * 	   마지막 칸이 두 칸 글자의 왼쪽 칸이라면 다음 덩어리로 넘긴다. clip 영역 밖의 덩어리는 건너뛴다.
+ *
+ * 	2) 글리프를 찾는다. 두 칸 글리프라도 오른쪽 칸(kWideTail)이 함께 있을 때만 두 칸을 그리고,
+ * 	   그렇지 않으면 왼쪽 절반만 그린다. 짝이 없는 kWideTail은 빈 칸으로 그린다.
+ *
+ * 	3) 불투명하다면 WriteString()처럼 strip_에 이어 붙인 뒤 한 번에 복사하고,
+ * 	   투명하다면 글자마다 WriteRect32ColorKey()로 복사한다.
+ *
+ * */
+
+
+
+
+
+
+namespace {
+    template <typename F>
+    void ForEachCodepoint(const char* s, F&& f) {
+        Utf8Decoder decoder;
+        for (; *s != '\0'; ++s) {
+            decoder.Feed(static_cast<uint8_t>(*s), f);
+        }
+    }
+
+    bool FindGlyph(const UnicodeFont* font, char32_t c, UnicodeFont::Glyph& glyph) {
+        if (!font) {
+            return false;
+        }
+        const FontAtlasEntry* entry = font->Find(c);
+        if (!entry && c >= 0x80) {
+            entry = font->Find(UnicodeFont::kReplacementCharacter);
+        }
+        if (!entry) {
+            return false;
+        }
+        glyph = font->GlyphOf(*entry);
+        return true;
+    }
+}
+
+int WriteUtf8(
+    PixelWriter& writer, int x, int y, const char* s,
+    const PixelColor& color, const UnicodeFont* font
+) {
+    const Rectangle<int> clip = writer.ClipRect();
+    ForEachCodepoint(s, [&](char32_t c) {
+        UnicodeFont::Glyph glyph;
+        if (!FindGlyph(font, c, glyph)) {
+            WriteAscii(writer, x, y, c < 0x80 ? static_cast<char>(c) : '?', color);
+            x += 8;
+            return;
+        }
+
+        const auto visible = Rectangle<int>{{x, y}, {glyph.width, font->Height()}} & clip;
+        for (int dy = visible.pos.y - y; dy < visible.pos.y + visible.size.y - y; ++dy) {
+            for (int dx = visible.pos.x - x; dx < visible.pos.x + visible.size.x - x; ++dx) {
+                if (glyph.Coverage(dx, dy) >= 128) {
+                    writer.WriteUnclipped(x + dx, y + dy, color);
+                }
+            }
+        }
+        x += glyph.width;
+    });
+    return x;
+}
+
+int MeasureUtf8(const char* s, const UnicodeFont* font) {
+    int width = 0;
+    ForEachCodepoint(s, [&](char32_t c) {
+        UnicodeFont::Glyph glyph;
+        width += FindGlyph(font, c, glyph) ? glyph.width : 8;
+    });
+    return width;
+}
+
+/*
+ * UTF-8 문자열을 코드 포인트 단위로 디코딩하여, 글리프마다 고유한 폭만큼 x를 옮기며 그린다.
+ * 폰트의 높이가 16이 아니어도 그릴 수 있으며, 폰트에 없는 아스키 문자는 8x16 폰트로 그린다.
+ * 글리프마다 clip 영역과 겹치는 부분만 검사하므로, clip 영역 밖의 글자는 x만 옮기고 넘어간다.
+ * 겹치는 부분의 픽셀은 WriteUnclipped()로 검사 없이 쓴다.
+ *
+ * */
@@ -2,6 +2,101 @@
 
 #include <cstdint>
 #include "../graphics/graphics.hpp"
+#include "unicode_font.hpp"
 
 void WriteAscii(PixelWriter& writer, int x, int y, char c, const PixelColor& color); 		// 터미널에 아스키 코드 1개를 작성하는 함수이다. 
 void print_str(PixelWriter& writer, int x, int y, const char* s, const PixelColor& color); 	// 터미널에 문자열을 작성하는 함수이다.
+
+int WriteUtf8( 											// UTF-8 문자열을 글리프의 폭에 맞추어 작성하고, 
+    PixelWriter& writer, int x, int y, const char* s, 						// 다음 글자를 쓸 x 좌표를 반환한다.
+    const PixelColor& color, const UnicodeFont* font
+);
+int MeasureUtf8(const char* s, const UnicodeFont* font); 					// UTF-8 문자열을 작성했을 때의 폭(픽셀)을 반환한다.
+
+/*
+ * WriteUtf8(), MeasureUtf8() :
+ * 	font의 글리프마다 고유한 폭(proportional)으로 글자를 배치한다. 창의 제목처럼 칸에 맞출 필요가 없는
+ * 	글자열에 사용한다. font가 nullptr이거나 글리프가 없는 아스키 문자는 8x16 폰트로,
+ * 	그 외의 글자는 U+FFFD(없다면 '?')로 그린다.
+ * */
+
+
+
+class GlyphCache {
+    public:
+        static const int kGlyphWidth = 8;
+        static const int kGlyphHeight = 16;
+        static const int kNumGlyphs = 256;
+        static const int kStripChars = 80;                              // WriteString()이 한 번에 이어 붙이는 최대 글자 수
+        static const uint32_t kTransparentKey = 0xffffffffu;
+        static const int kNumSlots = 128;                               // 아스키가 아닌 글리프를 펼쳐두는 슬롯의 수 (2의 거듭제곱)
+        static const char32_t kWideTail = 0xffffffffu;                  // 두 칸을 차지하는 글자의 오른쪽 칸을 나타내는 값
+
+        void Build(const NativePixelWriter& format, const PixelColor& fg, const PixelColor* bg);
+
+        const uint32_t* Glyph(char c) const {  return glyphs_[static_cast<uint8_t>(c)];  }
+        bool IsOpaque() const {  return opaque_;  }
+
+        void WriteAscii(NativePixelWriter& writer, int x, int y, char c) const;
+        void WriteString(NativePixelWriter& writer, int x, int y, const char* s, int length);
+
+        void SetFont(const UnicodeFont* font);
+        int Cells(char32_t c);
+        void WriteCells(NativePixelWriter& writer, int x, int y, const char32_t* cells, int length);
+
+    private:
+        struct Expanded {
+            const uint32_t* pixels;                                     // 폭이 kGlyphWidth * cells인 픽셀 배열
+            int cells;                                                  // 차지하는 칸 수 (1 또는 2)
+        };
+        Expanded lookup(char32_t c);
+        void expandAscii();
+        void expand(const UnicodeFont::Glyph& glyph, uint32_t* pixels, int stride) const;
+        void writeCell(NativePixelWriter& writer, int x, int y, const uint32_t* pixels, int cells, int stride) const;
+
+        uint32_t glyphs_[kNumGlyphs][kGlyphWidth * kGlyphHeight];
+        uint32_t strip_[kStripChars * kGlyphWidth * kGlyphHeight];
+        bool opaque_{false};
+        bool blend_{false};                                         // 픽셀 형식이 LerpPixels32()로 섞을 수 있는 형식인지의 여부
+
+        const UnicodeFont* font_{nullptr};
+        uint32_t fg_value_{0}, bg_value_{kTransparentKey};
+        uint32_t slots_[kNumSlots][2 * kGlyphWidth * kGlyphHeight];
+        char32_t slot_codepoints_[kNumSlots];                           // 슬롯에 펼쳐둔 글리프의 코드 포인트 (kWideTail이면 빈 슬롯)
+        uint8_t slot_cells_[kNumSlots];
+};
+
+/**
+ * @brief 256개의 글리프를 (전경색, 배경색, 픽셀 형식) 조합으로 미리 그려둔 캐시
+ *
+ * Build():
+ *  format의 Encode()로 모든 글리프를 8x16 크기의 32비트 픽셀 배열로 펼친다. 
+ *  bg가 nullptr이면 배경 픽셀은 kTransparentKey(투명)로 남는다. 
+ *  색상이나 픽셀 형식이 바뀌면 다시 호출해야 한다.
+ *
+ * WriteAscii():
+ *  글리프 하나를 writer에 복사한다. 불투명하다면 WriteRect32(), 투명하다면 WriteRect32ColorKey()를 사용한다.
+ *
+ * WriteString():
+ *  불투명한 캐시에서는 length개의 글리프를 strip_에 가로로 이어 붙인 뒤 한 번의 WriteRect32()로 복사한다.
+ *  투명한 캐시에서는 글자마다 WriteAscii()를 호출한다.
+ *
+ * SetFont(), Cells(), WriteCells():
+ *  아스키가 아닌 글자(코드 포인트)를 유니코드 폰트로 그린다. 폭이 8픽셀보다 넓은 글리프(한글 등)는
+ *  두 칸을 차지하며, 터미널은 오른쪽 칸에 kWideTail을 저장한다. WriteCells()는 WriteString()과
+ *  같이 strip에 글리프를 이어 붙이며, 짝이 맞지 않는 kWideTail은 빈 칸으로 그린다.
+ *  폰트가 없거나 글리프가 없으면 U+FFFD, 그것도 없으면 '?'로 그린다.
+ *
+ *  커버리지(안티에일리어싱) 폰트라면 아스키 글리프도 그 폰트로 다시 펼치며, 글리프를 펼칠 때 
+ *  LerpPixels32()로 전경색과 배경색을 섞어둔다. (불투명한 캐시에서만, 투명하다면 1비트처럼 그린다)
+ *
+ *  아스키가 아닌 글리프는 처음 그릴 때 slots_에 펼쳐둔다. 슬롯은 코드 포인트의 해시로 정해지는
+ *  direct-mapped 캐시이므로, 찾는 비용은 글자 수와 관계없이 태그 비교 한 번이다.
+ *  (없을 때만 UnicodeFont의 해시 테이블을 찾는다)
+ *
+ * PLUS:
+ *  글리프를 미리 펼쳐두는 이유:
+ *      free function WriteAscii()는 글자마다 16개의 행을 비트 단위로 시프트, 검사하고 
+ *      켜진 픽셀마다 가상 함수 Write()를 호출한다. 미리 펼쳐둔 글리프는 행마다 
+ *      32바이트를 복사하는 것으로 끝나며, 가상 함수 호출도 글자(또는 줄)마다 한 번이다.
+*/
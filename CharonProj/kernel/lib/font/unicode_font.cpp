@@ -0,0 +1,118 @@
+/**
+ * @file unicode_font.cpp
+*/
+
+#include <cstring>
+
+#include "unicode_font.hpp"
+
+extern const uint8_t _binary_unicodeFont_bin_start __attribute__((weak)); 			// 아틀라스 바이너리의 start 포인트를 불러온다.
+extern const uint8_t _binary_unicodeFont_bin_size __attribute__((weak)); 			// 아틀라스 바이너리의 크기를 불러온다.
+
+/*
+ * 아틀라스는 링크되지 않을 수도 있으므로 weak 심볼로 선언한다.
+ * 링크되지 않았다면 두 심볼의 주소는 0이 된다.
+ * */
+
+
+
+Error UnicodeFont::Load(const uint8_t* data, size_t size) {
+    if (size < sizeof(FontAtlasHeader)) { 								// 1)
+        return MAKE_ERROR(Error::kInvalidFont);
+    }
+    const auto header = reinterpret_cast<const FontAtlasHeader*>(data);
+    if (memcmp(header->magic, "CFNT", 4) != 0 || header->version != 1 || header->height == 0) {
+        return MAKE_ERROR(Error::kInvalidFont);
+    }
+
+    const size_t entries_size = sizeof(FontAtlasEntry) * header->num_glyphs;
+    if (entries_size > size - sizeof(FontAtlasHeader)) {
+        return MAKE_ERROR(Error::kInvalidFont);
+    }
+    const auto entries = reinterpret_cast<const FontAtlasEntry*>(data + sizeof(FontAtlasHeader));
+    const uint8_t* bitmaps = data + sizeof(FontAtlasHeader) + entries_size;
+    const size_t bitmaps_size = size - sizeof(FontAtlasHeader) - entries_size;
+    const bool coverage = header->flags & kFontAtlasCoverage;
+
+    for (uint32_t i = 0; i < header->num_glyphs; ++i) { 						// 2)
+        const int width = entries[i].Width();
+        const size_t glyph_size = static_cast<size_t>(header->height) * (coverage ? width : (width + 7) / 8);
+        if (width == 0 || width > kMaxGlyphWidth
+                || entries[i].offset > bitmaps_size || glyph_size > bitmaps_size - entries[i].offset) {
+            return MAKE_ERROR(Error::kInvalidFont);
+        }
+    }
+
+    int bits = 1; 												// 3)
+    while ((1u << bits) < 2 * header->num_glyphs) {
+        ++bits;
+    }
+    table_.assign(1u << bits, 0);
+    table_shift_ = 32 - bits;
+
+    for (uint32_t i = 0; i < header->num_glyphs; ++i) { 						// 4)
+        uint32_t slot = Hash(entries[i].Codepoint()) >> table_shift_;
+        while (table_[slot] != 0) {
+            slot = (slot + 1) & (table_.size() - 1);
+        }
+        table_[slot] = i + 1;
+    }
+
+    entries_ = entries;
+    bitmaps_ = bitmaps;
+    num_glyphs_ = header->num_glyphs;
+    height_ = header->height;
+    coverage_ = coverage;
+    return MAKE_ERROR(Error::kSuccess);
+}
+
+/*
+ * 아틀라스를 검사하고 해시 테이블을 만드는 함수이다.
+ *
+ * 동작방식:
+ * 	1) 헤더의 크기, magic, 버전을 확인한다.
+ *
+ * 	2) 모든 엔트리의 폭과 비트맵 위치가 파일 안에 있는지 확인한다.
+ * 	   이후 글리프를 그릴 때는 범위를 다시 검사하지 않는다.
+ *
+ * 	3) 글리프 수의 2배 이상인 2의 거듭제곱으로 테이블의 크기를 정한다.
+ * 	   테이블의 절반 이상이 비어있으므로 선형 탐사가 짧게 끝난다.
+ *
+ * 	4) 엔트리마다 해시값의 상위 비트로 슬롯을 정하고, 이미 사용중이라면 다음 슬롯에 넣는다.
+ * 	   같은 코드 포인트가 두 번 있다면 앞의 엔트리가 먼저 찾아진다.
+ *
+ * */
+
+
+
+const FontAtlasEntry* UnicodeFont::Find(char32_t codepoint) const {
+    if (num_glyphs_ == 0) {
+        return nullptr;
+    }
+
+    uint32_t slot = Hash(codepoint) >> table_shift_;
+    while (const uint32_t index = table_[slot]) {
+        if (entries_[index - 1].Codepoint() == codepoint) {
+            return &entries_[index - 1];
+        }
+        slot = (slot + 1) & (table_.size() - 1);
+    }
+    return nullptr;
+}
+
+UnicodeFont::Glyph UnicodeFont::GlyphOf(const FontAtlasEntry& entry) const {
+    const int width = entry.Width();
+    return {bitmaps_ + entry.offset, width, coverage_ ? width : (width + 7) / 8, coverage_};
+}
+
+
+
+Error LoadBuiltinUnicodeFont(UnicodeFont& font) {
+    if (&_binary_unicodeFont_bin_start == nullptr) {
+        return MAKE_ERROR(Error::kEmpty);
+    }
+    return font.Load(
+        &_binary_unicodeFont_bin_start,
+        reinterpret_cast<uintptr_t>(&_binary_unicodeFont_bin_size)
+    );
+}
@@ -0,0 +1,179 @@
+/**
+ * @file unicode_font.hpp
+ *
+ * tools/makefont.py --atlas로 만든 유니코드 글리프 아틀라스(CFNT)와 UTF-8 디코더를 정의한다.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../error/error.hpp"
+
+
+struct FontAtlasHeader {
+    char magic[4];                                  // "CFNT"
+    uint16_t version;
+    uint8_t height;                                 // 모든 글리프의 높이(픽셀)
+    uint8_t max_width;                              // 가장 넓은 글리프의 폭(픽셀)
+    uint32_t num_glyphs;
+    uint32_t flags;                                 // kFontAtlasCoverage
+} __attribute__((packed));
+
+const uint32_t kFontAtlasCoverage = 1u << 0;        // 비트맵이 픽셀마다 1바이트인 8비트 커버리지 마스크이다.
+
+struct FontAtlasEntry {
+    uint32_t code_width;                            // 하위 24비트는 코드 포인트, 상위 8비트는 폭(픽셀)
+    uint32_t offset;                                // 비트맵 영역의 시작에서 이 글리프의 비트맵까지의 거리
+
+    char32_t Codepoint() const {  return code_width & 0xffffffu;  }
+    int Width() const {  return code_width >> 24;  }
+} __attribute__((packed));
+
+/**
+ * @brief 아틀라스 파일의 형식
+ *
+ * [헤더][엔트리 x num_glyphs (코드 포인트 순)][비트맵]
+ * 글리프의 비트맵은 height개의 행으로, 행마다 ceil(폭 / 8)바이트이며 최상위 비트가 가장 왼쪽 픽셀이다.
+ * (kernelFont.bin과 같은 비트 순서)
+ *
+ * flags에 kFontAtlasCoverage가 있다면 행마다 폭만큼의 바이트이며, 각 바이트는 글리프가 픽셀을 
+ * 덮는 비율(0 ~ 255)이다. makefont.py --coverage가 큰 크기로 그려진 폰트를 축소하여 만든다.
+*/
+
+
+
+class UnicodeFont {
+    public:
+        static const int kMaxGlyphWidth = 16;
+        static const char32_t kReplacementCharacter = 0xfffd;
+
+        struct Glyph {
+            const uint8_t* bitmap;                      // height행, 행마다 bytes_per_row바이트
+            int width;                                  // 폭 (픽셀, 글자 사이의 간격)
+            int bytes_per_row;
+            bool coverage;                              // true라면 비트맵이 8비트 커버리지 마스크이다.
+
+            uint8_t Coverage(int x, int y) const {      // (x, y) 픽셀의 커버리지 (1비트 비트맵은 0 또는 255)
+                const uint8_t* row = bitmap + bytes_per_row * y;
+                if (coverage) {
+                    return row[x];
+                }
+                return ((row[x / 8] << (x % 8)) & 0x80u) ? 255 : 0;
+            }
+        };
+
+        Error Load(const uint8_t* data, size_t size);
+
+        const FontAtlasEntry* Find(char32_t codepoint) const;
+        Glyph GlyphOf(const FontAtlasEntry& entry) const;
+
+        int Height() const {  return height_;  }
+        bool HasCoverage() const {  return coverage_;  }
+        size_t NumGlyphs() const {  return num_glyphs_;  }
+
+    private:
+        static uint32_t Hash(char32_t codepoint) {  return codepoint * 0x9e3779b1u;  }
+
+        const FontAtlasEntry* entries_{nullptr};
+        const uint8_t* bitmaps_{nullptr};
+        size_t num_glyphs_{0};
+        int height_{0};
+        bool coverage_{false};
+
+        std::vector<uint32_t> table_;                   // 엔트리 인덱스 + 1 (0은 빈 슬롯)
+        int table_shift_{32};                           // 해시값의 상위 (32 - table_shift_)비트를 슬롯 번호로 사용한다.
+};
+
+/**
+ * @brief 아틀라스에서 코드 포인트로 글리프를 찾는 폰트
+ *
+ * Load():
+ *  메모리에 올라온 아틀라스를 검사하고, 코드 포인트 -> 엔트리의 해시 테이블을 만든다.
+ *  데이터는 복사하지 않으므로 폰트를 사용하는 동안 유지되어야 한다. 힙을 사용하므로
+ *  InitializeHeap() 이후에 호출한다. 형식이 맞지 않으면 kInvalidFont를 반환한다.
+ *
+ * Find():
+ *  글리프가 없다면 nullptr을 반환한다.
+ *
+ * PLUS:
+ *  이진 탐색 대신 해시 테이블을 사용하는 이유:
+ *      유니폰트의 BMP는 약 5만 7천개의 글리프로, 이진 탐색은 글자마다 16번의 비교와
+ *      예측하기 어려운 분기를 거친다. 테이블의 크기를 글리프 수의 2배 이상인 2의 거듭제곱으로
+ *      잡고 곱셈 해시(fibonacci hashing)와 선형 탐사를 사용하므로, 대부분 한두 번의 비교로 끝난다.
+*/
+
+
+
+class Utf8Decoder {
+    public:
+        template <typename F>
+        void Feed(uint8_t byte, F&& emit) {
+            if (remaining_ > 0 && (byte & 0xc0) == 0x80) {                      // 1)
+                codepoint_ = (codepoint_ << 6) | (byte & 0x3f);
+                if (--remaining_ == 0) {
+                    const bool valid = codepoint_ >= min_ && codepoint_ <= 0x10ffff
+                        && !(0xd800 <= codepoint_ && codepoint_ <= 0xdfff);
+                    emit(valid ? codepoint_ : UnicodeFont::kReplacementCharacter);
+                }
+                return;
+            }
+
+            if (remaining_ > 0) {                                               // 2)
+                remaining_ = 0;
+                emit(UnicodeFont::kReplacementCharacter);
+            }
+
+            if (byte < 0x80) {                                                  // 3)
+                emit(byte);
+            } else if ((byte & 0xe0) == 0xc0) {
+                start(byte & 0x1f, 1, 0x80);
+            } else if ((byte & 0xf0) == 0xe0) {
+                start(byte & 0x0f, 2, 0x800);
+            } else if ((byte & 0xf8) == 0xf0) {
+                start(byte & 0x07, 3, 0x10000);
+            } else {
+                emit(UnicodeFont::kReplacementCharacter);
+            }
+        }
+
+    private:
+        void start(char32_t bits, int remaining, char32_t min) {
+            codepoint_ = bits;
+            remaining_ = remaining;
+            min_ = min;
+        }
+
+        char32_t codepoint_{0};
+        int remaining_{0};                              // 남은 연속 바이트(10xxxxxx)의 수
+        char32_t min_{0};                               // 과잉 길이(overlong) 인코딩을 거르기 위한 최솟값
+};
+
+/**
+ * @brief 바이트 단위로 UTF-8을 디코딩하여 완성된 코드 포인트마다 emit을 호출한다.
+ *
+ * 상태를 가지므로, 한 글자가 두 번의 Write() 호출에 나뉘어 들어와도 올바르게 디코딩된다.
+ *
+ * 동작방식:
+ *  1) 연속 바이트라면 코드 포인트에 6비트를 더한다. 마지막 바이트라면 과잉 길이,
+ *     범위 초과, 서로게이트를 검사하여 코드 포인트 또는 U+FFFD를 내보낸다.
+ *
+ *  2) 연속 바이트가 와야 할 자리에 다른 바이트가 왔다면 끊긴 글자를 U+FFFD로 내보내고,
+ *     이 바이트는 새 글자의 시작으로 처리한다.
+ *
+ *  3) 선두 바이트의 형태로 글자의 길이를 정한다. 잘못된 선두 바이트는 U+FFFD가 된다.
+*/
+
+
+
+Error LoadBuiltinUnicodeFont(UnicodeFont& font);
+/**
+ * @brief 커널에 링크된 아틀라스(lib/font/unicodeFont.bin)를 불러온다.
+ *
+ * 아틀라스는 선택 사항이다. (make UNICODE_FONT=<.hex|.bdf>) 링크되지 않았다면 kEmpty를 반환하며,
+ * 이때 터미널은 기존의 8x16 아스키 폰트만 사용한다.
+ *
+ * make UNICODE_FONT_AA=<배율>로 만들면 커버리지 아틀라스가 되어 글자가 안티에일리어싱되며,
+ * 아스키 글자도 이 폰트로 그린다. (배율 x 16픽셀 높이로 그려진 폰트를 넘겨야 한다)
+*/
@@ -5,6 +5,7 @@
 enum PixelFormat { 		// graphic.hpp에서 사용되는 픽셀 형식을 정의하는 열거형이다.
   kPixelRGBResv8BitPerColor, 	 
   kPixelBGRResv8BitPerColor, 	
+  kPixelBitMask,
 };
 
 /*
@@ -14,6 +15,23 @@ enum PixelFormat { 		// graphic.hpp에서 사용되는 픽셀 형식을 정의
  * kPixelBGRResv8BitPerColor:
  * 	BGR(Reverse) 형태로 8비트 색상을 정의한다.
  *
+ * kPixelBitMask:
+ * 	각 색상의 비트 위치가 FrameBufferConfig::pixel_bitmask로 주어진다. (32비트 픽셀)
+ *
+ * */
+
+
+struct PixelBitmask {
+  uint32_t red_mask;
+  uint32_t green_mask;
+  uint32_t blue_mask;
+  uint32_t reserved_mask;
+};
+
+/*
+ * UEFI GOP의 EFI_PIXEL_BITMASK와 같은 구조이다. 
+ * pixel_format이 kPixelBitMask일 때만 의미가 있다.
+ *
  * */
 
 
@@ -23,6 +41,7 @@ struct FrameBufferConfig {      // 1)프레임 버퍼 설정을 저정하는 열
   uint32_t horizontal_resolution;
   uint32_t vertical_resolution;
   enum PixelFormat pixel_format;
+  struct PixelBitmask pixel_bitmask;
 };
 
 /*
@@ -41,6 +60,9 @@ struct FrameBufferConfig {      // 1)프레임 버퍼 설정을 저정하는 열
  * pixel_format:
  * 	픽셀 형식을 나타내는 열거형 변수이다.
  *
+ * pixel_bitmask:
+ * 	kPixelBitMask 형식일 때 각 색상이 차지하는 비트를 나타낸다.
+ *
  * ============================================
  *
  * 1) 프레임 버퍼
@@ -0,0 +1,293 @@
+/**
+ * @file back_buffer.cpp
+*/
+
+#include <cstring>
+
+#include "back_buffer.hpp"
+#include "pixel_ops.hpp"
+
+
+namespace {
+    bool Touches(const Rectangle<int>& a, const Rectangle<int>& b, int slack = 0) {
+        return a.pos.x <= b.pos.x + b.size.x + slack && b.pos.x <= a.pos.x + a.size.x + slack
+            && a.pos.y <= b.pos.y + b.size.y + slack && b.pos.y <= a.pos.y + a.size.y + slack;
+    }
+}
+
+
+void DirtyRegion::Add(const Rectangle<int>& rect) {
+    if (rect.IsEmpty()) {
+        return;
+    }
+
+    if (count_ > 0) {                                           // 1)
+        auto& last = rects_[last_];
+        if (last.Contains(rect)) {
+            return;
+        }
+        if (Touches(last, rect, kMergeSlack)) {
+            last = last | rect;
+            return;
+        }
+    }
+
+    for (int i = 0; i < count_; ++i) {                          // 2)
+        if (rects_[i].Contains(rect)) {
+            last_ = i;
+            return;
+        }
+    }
+
+    Rectangle<int> merged = rect;
+    for (int i = 0; i < count_; ) {                             // 3)
+        if (Touches(rects_[i], merged)) {
+            merged = merged | rects_[i];
+            rects_[i] = rects_[--count_];
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+
+    if (count_ < kMaxRects) {                                   // 4)
+        last_ = count_;
+        rects_[count_++] = merged;
+        return;
+    }
+
+    int best = 0;                                               // 5)
+    int best_growth = (rects_[0] | merged).Area() - rects_[0].Area();
+    for (int i = 1; i < count_; ++i) {
+        const int growth = (rects_[i] | merged).Area() - rects_[i].Area();
+        if (growth < best_growth) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    rects_[best] = rects_[best] | merged;
+    last_ = best;
+}
+
+/**
+ * @brief dirty 영역에 직사각형을 추가한다.
+ *
+ * 동작방식:
+ *  1) 빠른 경로: 마지막으로 추가하거나 합친 직사각형에 포함된다면 아무것도 하지 않고,
+ *     kMergeSlack 픽셀 안에 있다면 그 직사각형에 바로 합친다. Write()로 점을 찍는 글자나 도형은
+ *     픽셀마다 목록 전체를 훑지 않고 이 경로에서 끝난다. 합친 직사각형이 다른 직사각형과 
+ *     겹칠 수도 있지만, 겹친 부분이 Flush()에서 두 번 복사될 뿐 결과는 같다.
+ *
+ *  2) 이미 기록된 직사각형 안에 포함된다면 아무것도 하지 않는다. 
+ *     글자처럼 같은 곳에 여러 번 그리는 경우 대부분 여기서 끝난다.
+ *
+ *  3) 겹치거나 맞닿은 직사각형을 목록에서 빼내어 새 직사각형과 합친다. 
+ *     합친 결과가 다른 직사각형과 새로 맞닿을 수 있으므로 처음부터 다시 확인한다.
+ *
+ *  4) 빈 자리가 있다면 합친 직사각형을 추가한다.
+ *
+ *  5) 목록이 가득 찼다면 합쳤을 때 넓이가 가장 적게 늘어나는 직사각형과 합친다.
+*/
+
+
+
+BackBuffer::BackBuffer(FrameBufferWriter& target)
+    : target_{target}, width_{target.Width()}, height_{target.Height()},
+      pixels_(static_cast<size_t>(target.Width()) * target.Height()) {
+    target_.ReadRect32({0, 0}, {width_, height_}, pixels_.data(), width_);
+}
+
+/*
+ * 지금까지 프레임 버퍼에 직접 그려진 화면(바탕화면, 부팅 메시지 등)을 이어받기 위해
+ * 생성할 때 한 번 프레임 버퍼 전체를 읽어온다.
+ *
+ */
+
+
+void BackBuffer::Write(int x, int y, const PixelColor& c) {
+    if (!ClipRect().Contains(Vector2D<int>{x, y})) {
+        return;
+    }
+    *PixelAt(x, y) = target_.Encode(c);
+    dirty_.Add({{x, y}, {1, 1}});
+}
+
+void BackBuffer::WriteUnclipped(int x, int y, const PixelColor& c) {
+    *PixelAt(x, y) = target_.Encode(c);
+    dirty_.Add({{x, y}, {1, 1}});
+}
+
+void BackBuffer::FillSpan(int x, int y, int length, const PixelColor& c) {
+    FillRect({x, y}, {length, 1}, c);
+}
+
+void BackBuffer::FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+
+    const uint32_t value = target_.Encode(c);
+    for (int dy = 0; dy < s.y; ++dy) {
+        FillPixels32(PixelAt(p.x, p.y + dy), value, s.x);
+    }
+    dirty_.Add({p, s});
+}
+
+void BackBuffer::CopySpan(int x, int y, const PixelColor* src, int length) {
+    BlitRect({x, y}, {length, 1}, src, length);
+}
+
+void BackBuffer::BlitRect(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const PixelColor* src, int src_stride
+) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        uint32_t* row = PixelAt(p.x, p.y + dy);
+        const PixelColor* src_row = src + src_stride * dy;
+        for (int dx = 0; dx < s.x; ++dx) {
+            row[dx] = target_.Encode(src_row[dx]);
+        }
+    }
+    dirty_.Add({p, s});
+}
+
+void BackBuffer::WriteRect32(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const uint32_t* src, int src_stride
+) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        CopyPixels32(PixelAt(p.x, p.y + dy), src + src_stride * dy, s.x);
+    }
+    dirty_.Add({p, s});
+}
+
+void BackBuffer::WriteRect32ColorKey(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const uint32_t* src, int src_stride, uint32_t key
+) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        CopyPixels32ColorKey(PixelAt(p.x, p.y + dy), src + src_stride * dy, s.x, key);
+    }
+    dirty_.Add({p, s});
+}
+
+void BackBuffer::BlendRect32(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const uint32_t* src, int src_stride, uint8_t opacity, bool src_has_alpha
+) {
+    if (!CanBlend()) {
+        WriteRect32(pos, size, src, src_stride);
+        return;
+    }
+
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        BlendPixels32(PixelAt(p.x, p.y + dy), src + src_stride * dy, s.x, opacity, src_has_alpha);
+    }
+    dirty_.Add({p, s});
+}
+
+void BackBuffer::MoveRect(const Vector2D<int>& dst_pos, const Rectangle<int>& src) {
+    Vector2D<int> dst = dst_pos;
+    Rectangle<int> from = src;
+    if (!ClipMove(dst, from, ClipRect())) {
+        return;
+    }
+
+    if (from.pos.x == 0 && from.size.x == width_) {
+        memmove(PixelAt(0, dst.y), PixelAt(0, from.pos.y),
+                sizeof(uint32_t) * width_ * from.size.y);
+    } else if (dst.y <= from.pos.y) {
+        for (int dy = 0; dy < from.size.y; ++dy) {
+            memmove(PixelAt(dst.x, dst.y + dy), PixelAt(from.pos.x, from.pos.y + dy),
+                    sizeof(uint32_t) * from.size.x);
+        }
+    } else {
+        for (int dy = from.size.y - 1; dy >= 0; --dy) {
+            memmove(PixelAt(dst.x, dst.y + dy), PixelAt(from.pos.x, from.pos.y + dy),
+                    sizeof(uint32_t) * from.size.x);
+        }
+    }
+    dirty_.Add({dst, from.size});
+}
+
+/*
+ * 화면 너비 전체를 세로로 옮기는 경우(터미널 스크롤 등) 옮길 줄들이 메모리에서 
+ * 연속되어 있으므로 한 번의 memmove()로 끝난다. 그 외에는 겹치지 않는 순서로 줄마다 옮긴다.
+ * 옮긴 결과는 Flush()에서 다른 dirty 영역과 같이 프레임 버퍼로 복사된다.
+ *
+ */
+
+
+void BackBuffer::Flush() {
+    Rectangle<int> old_cursor, new_cursor;
+    if (cursor_ && cursor_->Commit(old_cursor, new_cursor)) {                   // 1)
+        dirty_.Add(old_cursor);
+        dirty_.Add(new_cursor);
+    }
+    if (dirty_.Count() == 0) {
+        return;
+    }
+
+    if (cursor_) {                                                              // 2)
+        cursor_->Stamp(pixels_.data(), width_);
+    }
+
+    for (int i = 0; i < dirty_.Count(); ++i) {                                  // 3)
+        const auto& rect = dirty_[i];
+        target_.WriteRect32(rect.pos, rect.size, PixelAt(rect.pos.x, rect.pos.y), width_);
+    }
+    dirty_.Clear();
+
+    if (cursor_) {                                                              // 4)
+        cursor_->Restore(pixels_.data(), width_);
+    }
+}
+
+/**
+ * @brief dirty 영역을 프레임 버퍼에 복사하고, 커서를 가장 마지막에 그린다.
+ *
+ * 동작방식:
+ *  1) 커서가 움직였다면 이전 위치(지울 곳)와 새 위치(그릴 곳)를 dirty 영역에 추가한다.
+ *     한 프레임 동안 여러 번 움직였어도 최종 위치만 반영된다.
+ *
+ *  2) back buffer에 커서를 덮어 그린다. 커서 아래의 픽셀은 커서 평면이 저장해둔다.
+ *
+ *  3) dirty 영역의 각 직사각형을 줄 단위로 프레임 버퍼에 복사한다.
+ *     한 줄은 메모리에서 연속되어 있으므로 CopyPixels32()가 한 번에 복사한다.
+ *
+ *  4) 저장해둔 픽셀로 커서를 지운다. 프레임 버퍼에는 커서가 남고, back buffer에는 
+ *     커서 없는 화면이 남으므로 이후 레이어나 터미널이 커서 아래를 다시 그려도 망가지지 않는다.
+*/
+
+
+void BackBuffer::MarkDirty(const Rectangle<int>& area) {
+    Vector2D<int> p = area.pos, s = area.size, offset;
+    if (ClipRectangle(p, s, offset, width_, height_)) {
+        dirty_.Add({p, s});
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file back_buffer.hpp
+ *
+ * 일반 메모리에 화면 전체의 사본(back buffer)을 두고, 변경된 영역만 프레임 버퍼로 복사한다.
+*/
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "graphics.hpp"
+#include "cursor_plane.hpp"
+
+
+class DirtyRegion {
+    public:
+        static const int kMaxRects = 32;
+        static const int kMergeSlack = 8;                               // 이 거리(픽셀) 안의 직사각형은 마지막 직사각형에 바로 합친다.
+
+        void Add(const Rectangle<int>& rect);
+        void Clear() {  count_ = 0;  last_ = 0;  }
+
+        int Count() const {  return count_;  }
+        const Rectangle<int>& operator[](int i) const {  return rects_[i];  }
+
+    private:
+        std::array<Rectangle<int>, kMaxRects> rects_{};
+        int count_{0};
+        int last_{0};                                                   // 마지막으로 추가하거나 합친 직사각형의 위치
+};
+
+/**
+ * @brief 다시 그려야 하는(dirty) 영역을 최대 kMaxRects개의 직사각형으로 기록한다.
+ *
+ * 점이나 글자의 픽셀처럼 앞서 추가한 직사각형 바로 옆에 이어서 추가되는 경우가 많으므로,
+ * 마지막 직사각형에 포함되거나 kMergeSlack 안에 있다면 목록을 훑지 않고 바로 합친다.
+ * 그 외에는 새 직사각형이 기존 직사각형과 겹치거나 맞닿으면 둘을 합친다. 
+ * 목록이 가득 찼다면 합쳤을 때 넓이가 가장 적게 늘어나는 직사각형과 합친다.
+ * 따라서 기록된 영역은 실제로 변경된 영역보다 조금 넓을 수는 있어도 좁지는 않다.
+*/
+
+
+
+class BackBuffer : public NativePixelWriter {
+    public:
+        explicit BackBuffer(FrameBufferWriter& target);
+
+        virtual int Width() const override {  return width_;  }
+        virtual int Height() const override {  return height_;  }
+
+        virtual void Write(int x, int y, const PixelColor& c) override;
+        virtual void WriteUnclipped(int x, int y, const PixelColor& c) override;
+        virtual void FillSpan(int x, int y, int length, const PixelColor& c) override;
+        virtual void FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c) override;
+        virtual void CopySpan(int x, int y, const PixelColor* src, int length) override;
+        virtual void BlitRect(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const PixelColor* src, int src_stride
+        ) override;
+
+        virtual uint32_t Encode(const PixelColor& c) const override {  return target_.Encode(c);  }
+        virtual bool CanBlend() const override {  return target_.CanBlend();  }
+        virtual void WriteRect32(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride
+        ) override;
+        virtual void WriteRect32ColorKey(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride, uint32_t key
+        ) override;
+        virtual void BlendRect32(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride, uint8_t opacity, bool src_has_alpha
+        ) override;
+        virtual void MoveRect(const Vector2D<int>& dst_pos, const Rectangle<int>& src) override;
+
+        virtual void Flush() override;
+
+        void MarkDirty(const Rectangle<int>& area);
+        void SetCursorPlane(CursorPlane* cursor) {  cursor_ = cursor;  }
+
+    private:
+        FrameBufferWriter& target_;
+        const int width_, height_;
+        std::vector<uint32_t> pixels_;
+        DirtyRegion dirty_;
+        CursorPlane* cursor_{nullptr};
+
+        uint32_t* PixelAt(int x, int y) {  return &pixels_[width_ * y + x];  }
+};
+
+/**
+ * @brief 프레임 버퍼 대신 일반 메모리에 그리는 PixelWriter
+ *
+ * 픽셀은 target의 Encode()로 프레임 버퍼와 같은 32비트 형식으로 저장되므로,
+ * Flush()는 형식 변환 없이 줄 단위 복사만 하면 된다.
+ *
+ * Write() ~ BlitRect(), WriteRect32(), WriteRect32ColorKey(), BlendRect32(), MoveRect():
+ *  back buffer에만 그리고, 그린 영역을 dirty 영역에 추가한다. clip 영역(기본은 화면) 밖은 잘라낸다.
+ *
+ * Flush():
+ *  dirty 영역만 프레임 버퍼로 복사하고 dirty 영역을 비운다. 
+ *  커서 평면이 설정되어 있다면 복사하는 동안에만 커서를 가장 위에 그린다.
+ *
+ * MarkDirty():
+ *  그리지 않은 영역을 강제로 다시 복사하게 한다.
+ *
+ * SetCursorPlane():
+ *  Flush()에서 마지막으로 그릴 커서 평면을 설정한다.
+ *
+ * PLUS:
+ *  back buffer를 사용하는 이유:
+ *      프레임 버퍼(VRAM)는 읽기가 매우 느리고, 쓰기도 일반 메모리보다 느리다. 
+ *      또한 레이어를 아래부터 차례로 덮어 그리는 동안의 중간 상태가 화면에 그대로 보여 
+ *      깜빡임(tearing)이 생긴다. 모든 그리기를 일반 메모리에서 끝낸 뒤 최종 결과만 
+ *      연속된 줄 단위로 복사하면 두 문제가 함께 해결된다.
+*/
@@ -0,0 +1,103 @@
+/**
+ * @file cursor_plane.cpp
+*/
+
+#include "cursor_plane.hpp"
+#include "pixel_ops.hpp"
+
+
+CursorPlane::CursorPlane(
+    const NativePixelWriter& format, Vector2D<int> size, Vector2D<int> screen_size
+) : format_{format}, size_{size}, screen_size_{screen_size},
+    image_(static_cast<size_t>(size.x) * size.y, kTransparentKey),
+    save_under_(static_cast<size_t>(size.x) * size.y) {
+}
+
+void CursorPlane::SetPixel(int x, int y, const PixelColor& c) {
+    if (x < 0 || y < 0 || x >= size_.x || y >= size_.y) {
+        return;
+    }
+    image_[size_.x * y + x] = format_.Encode(c);
+    redraw_ = true;
+}
+
+
+void CursorPlane::Move(Vector2D<int> position) {
+    target_ = Clamp(position);
+}
+
+void CursorPlane::MoveRelative(Vector2D<int> displacement) {
+    Vector2D<int> next = target_;
+    next += displacement;
+    target_ = Clamp(next);
+}
+
+Vector2D<int> CursorPlane::Position() const {
+    return target_;
+}
+
+Vector2D<int> CursorPlane::Clamp(Vector2D<int> position) const {
+    return {
+        std::min(std::max(position.x, 0), screen_size_.x - 1),
+        std::min(std::max(position.y, 0), screen_size_.y - 1)
+    };
+}
+
+Rectangle<int> CursorPlane::AreaAt(Vector2D<int> position) const {
+    return Rectangle<int>{position, size_} & Rectangle<int>{{0, 0}, screen_size_};
+}
+
+
+bool CursorPlane::Commit(Rectangle<int>& old_area, Rectangle<int>& new_area) {
+    if (!redraw_ && target_.x == position_.x && target_.y == position_.y) {
+        return false;
+    }
+
+    old_area = AreaAt(position_);
+    position_ = target_;
+    new_area = AreaAt(position_);
+    redraw_ = false;
+    return true;
+}
+
+/*
+ * 마지막 Commit() 이후 MoveRelative()가 몇 번 호출되었든 이전 위치와 최종 위치만 비교하므로,
+ * 한 프레임 동안의 이동은 두 영역을 다시 복사하는 것으로 끝난다.
+ *
+ */
+
+
+void CursorPlane::Stamp(uint32_t* surface, int stride) {
+    stamped_ = AreaAt(position_);                                               // 1)
+    const int x0 = stamped_.pos.x - position_.x;
+    const int y0 = stamped_.pos.y - position_.y;
+
+    for (int dy = 0; dy < stamped_.size.y; ++dy) {
+        uint32_t* row = surface + stride * (stamped_.pos.y + dy) + stamped_.pos.x;
+        CopyPixels32(&save_under_[size_.x * dy], row, stamped_.size.x);        // 2)
+        CopyPixels32ColorKey(                                                   // 3)
+            row, &image_[size_.x * (y0 + dy) + x0], stamped_.size.x, kTransparentKey
+        );
+    }
+}
+
+void CursorPlane::Restore(uint32_t* surface, int stride) {
+    for (int dy = 0; dy < stamped_.size.y; ++dy) {
+        uint32_t* row = surface + stride * (stamped_.pos.y + dy) + stamped_.pos.x;
+        CopyPixels32(row, &save_under_[size_.x * dy], stamped_.size.x);
+    }
+    stamped_ = {{0, 0}, {0, 0}};
+}
+
+/**
+ * @brief 표면에 커서를 그리고(Stamp), 그리기 전의 픽셀로 되돌린다(Restore).
+ *
+ * 동작방식:
+ *  1) 커서 영역을 화면 크기로 잘라낸다. 화면 오른쪽, 아래쪽 끝에서는 커서의 일부만 그려진다.
+ *
+ *  2) 커서가 덮을 픽셀을 줄 단위로 save_under_에 저장한다.
+ *
+ *  3) 투명하지 않은 픽셀만 표면에 복사한다.
+ *
+ * Restore()는 저장해둔 줄을 그대로 되돌리며, Stamp()와 항상 짝을 지어 호출해야 한다.
+*/
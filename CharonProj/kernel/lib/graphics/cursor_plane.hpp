@@ -0,0 +1,67 @@
+/**
+ * @file cursor_plane.hpp
+ *
+ * 화면의 가장 위에 겹쳐 그리는 소프트웨어 커서 평면(cursor plane)을 정의한다.
+*/
+
+#pragma once
+
+#include <vector>
+#include "graphics.hpp"
+
+
+class CursorPlane {
+    public:
+        static const uint32_t kTransparentKey = 0xffffffffu;
+
+        CursorPlane(const NativePixelWriter& format, Vector2D<int> size, Vector2D<int> screen_size);
+
+        void SetPixel(int x, int y, const PixelColor& c);
+
+        void Move(Vector2D<int> position);
+        void MoveRelative(Vector2D<int> displacement);
+        Vector2D<int> Position() const;
+
+        bool Commit(Rectangle<int>& old_area, Rectangle<int>& new_area);
+        void Stamp(uint32_t* surface, int stride);
+        void Restore(uint32_t* surface, int stride);
+
+    private:
+        const NativePixelWriter& format_;
+        const Vector2D<int> size_, screen_size_;
+        std::vector<uint32_t> image_, save_under_;
+
+        Vector2D<int> position_{0, 0};                  // 화면에 마지막으로 반영된 위치
+        Vector2D<int> target_{0, 0};                    // 아직 반영하지 않은 다음 위치
+        bool redraw_{true};                             // 위치와 관계없이 다음 Commit()에서 다시 그릴지 여부
+        Rectangle<int> stamped_{{0, 0}, {0, 0}};        // Stamp()로 그린(잘라낸) 영역
+
+        Vector2D<int> Clamp(Vector2D<int> position) const;
+        Rectangle<int> AreaAt(Vector2D<int> position) const;
+};
+
+/**
+ * @brief 레이어와 별개로 화면 가장 위에 그려지는 커서 평면
+ *
+ * 커서 이미지는 format의 Encode()로 프레임 버퍼 형식으로 저장해두고,
+ * SetPixel()로 칠하지 않은 픽셀은 kTransparentKey(투명)로 남는다.
+ *
+ * Move(), MoveRelative():
+ *  위치를 바로 그리지 않고 target_만 바꾼다. 한 프레임 동안 들어온 여러 HID 보고서의
+ *  이동량은 다음 Commit()에서 한 번에 반영된다. 위치는 이동할 때마다 커서의 끝(0, 0)이
+ *  화면 안에 남도록 잘라낸다.
+ *
+ * Commit():
+ *  모아둔 이동을 반영한다. 다시 그려야 한다면 이전 영역과 새 영역을 돌려주고 true를 반환한다.
+ *
+ * Stamp(), Restore():
+ *  화면 크기의 32비트 표면(surface)에 커서를 그리기 전에 아래 픽셀을 save_under_에 저장하고,
+ *  Restore()에서 되돌린다. BackBuffer::Flush()가 프레임 버퍼로 복사하는 동안에만 커서를
+ *  그려두므로, back buffer에는 항상 커서가 없는 화면이 남는다.
+ *
+ * PLUS:
+ *  지울 색으로 덮는 대신 save-under를 사용하는 이유:
+ *      커서 아래가 바탕화면이라고 가정하고 배경색으로 지우면, 창 위를 지나간 자리가
+ *      배경색으로 망가진다. 그리기 직전의 픽셀을 저장했다가 되돌리면 아래에 무엇이
+ *      있든 그대로 복구된다.
+*/
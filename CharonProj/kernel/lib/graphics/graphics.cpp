@@ -3,6 +3,8 @@
 */
 
 
+#include <cstring>
+
 #include "graphics.hpp"
 
 
@@ -57,164 +59,666 @@ PixelColor Olive = {128, 128, 0};
 
 
 
-void RGBResv8BitPerColorPixelWriter::Write(int x, int y, const PixelColor& c) 
-{
-    auto p = PixelAt(x, y); 		// 1)
-    p[0] = c.r;   				// 2)
-    p[1] = c.g; 				// 3)
-    p[2] = c.b; 				// 4)
+void PixelWriter::FillSpan(int x, int y, int length, const PixelColor& c) {
+    Vector2D<int> p{x, y}, s{length, 1}, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+    for (int dx = 0; dx < s.x; ++dx) {
+        Write(p.x + dx, p.y, c);
+    }
+}
+
+void PixelWriter::BlendSpan(int x, int y, int length, const PixelColor& c, uint8_t alpha) {
+    if (alpha >= 128) {
+        FillSpan(x, y, length, c);
+    }
+}
+
+void PixelWriter::FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+    for (int dy = 0; dy < s.y; ++dy) {
+        FillSpan(p.x, p.y + dy, s.x, c);
+    }
+}
+
+void PixelWriter::CopySpan(int x, int y, const PixelColor* src, int length) {
+    Vector2D<int> p{x, y}, s{length, 1}, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+    src += offset.x;
+    for (int dx = 0; dx < s.x; ++dx) {
+        Write(p.x + dx, p.y, src[dx]);
+    }
+}
+
+void PixelWriter::BlitRect(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const PixelColor* src, int src_stride
+) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, ClipRect())) {
+        return;
+    }
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        CopySpan(p.x, p.y + dy, src + src_stride * dy, s.x);
+    }
 }
 
-/* 
- * 이 함수는 graphics.hpp에 정의된 RGBResv8BitPerColorPixelWriter 클래스의 가상함수인 Write()의 구현 코드이다.
+/*
+ * PixelWriter의 기본 구현으로, Write()만 정의한 PixelWriter(Window::WindowPainter 등)도 
+ * 여러 픽셀을 한 번에 쓰는 함수를 그대로 사용할 수 있게 해준다.
+ * 
+ * 영역은 함수마다 한 번 clip 영역으로 잘라낸 뒤 그린다. 
  *
- * 동작방식: 
- * 	1) auto(uint8_t) 자료형으로 선언된 p변수에 PixelAt()함수를 이용하여 얻은 특정 픽셀의 메모리 위치값을 할당한다.
- * 	2) p의 첫 번째 요소의 RGB값 중 R값을 할당한다.
- * 	3) p의 첫 번째 요소의 RGB값 중 G값을 할당한다.
- * 	4) p의 첫 번째 요소의 RGB값 중 B값을 할당한다.
+ */
+
+
+
+bool PixelWriter::PushClip(const Rectangle<int>& rect) {
+    if (clip_depth_ == kMaxClipDepth) {
+        return false;
+    }
+    clips_[clip_depth_] = ClipRect() & rect;
+    ++clip_depth_;
+    return true;
+}
+
+void PixelWriter::PopClip() {
+    if (clip_depth_ > 0) {
+        --clip_depth_;
+    }
+}
+
+/*
+ * 새 clip 영역은 항상 이전 영역과의 교집합이므로, 안쪽에서 그리는 코드가 
+ * 바깥에서 정한 영역을 넓힐 수 없다. 겹치지 않는다면 빈 영역이 되어 아무것도 그려지지 않는다.
  *
- * */
+ */
 
 
-void BGRResv8BitPerColorPixelWriter::Write(int x, int y, const PixelColor& c) 
-{
-    auto p = PixelAt(x, y);
-    p[0] = c.b;
-    p[1] = c.g;
-    p[2] = c.r;
+
+void NativePixelWriter::BlendSpan(int x, int y, int length, const PixelColor& c, uint8_t alpha) {
+    if (!CanBlend()) {
+        PixelWriter::BlendSpan(x, y, length, c, alpha);
+        return;
+    }
+
+    uint32_t pixels[32];
+    FillPixels32(pixels, Encode(c), 32);
+    for (int dx = 0; dx < length; dx += 32) {
+        const int n = std::min(length - dx, 32);
+        BlendRect32({x + dx, y}, {n, 1}, pixels, n, alpha, false);
+    }
 }
 
 /*
- * 위의 함수와 동일하게 작동한다.
- * 
+ * 불투명한 픽셀을 opacity = alpha로 BlendRect32()에 넘기면 dst * (1 - alpha) + c * alpha가 된다.
+ * 8:8:8 형식이 아니라면(CanBlend()) 섞지 않고 PixelWriter의 기본 구현처럼 절반을 기준으로 채운다.
+ * 가장자리의 구간은 대부분 몇 픽셀이므로, 32픽셀 버퍼 하나를 반복해서 사용한다.
+ *
  */
 
-void paintRectangle(
-    PixelWriter& writer, const Vector2D<int>& pos,
-    const Vector2D<int>& size, const PixelColor& c
+
+
+bool ClipRectangle(
+    Vector2D<int>& pos, Vector2D<int>& size, Vector2D<int>& src_offset,
+    int width, int height
+) {
+    return ClipRectangle(pos, size, src_offset, {{0, 0}, {width, height}});
+}
+
+bool ClipRectangle(
+    Vector2D<int>& pos, Vector2D<int>& size, Vector2D<int>& src_offset,
+    const Rectangle<int>& bounds
 ) {
-    for (int dx = 0; dx < size.x; ++dx) {
-        writer.Write(pos.x + dx, pos.y, c);
-        writer.Write(pos.x + dx, pos.y + size.y - 1, c);
+    src_offset = {0, 0};
+    if (pos.x < bounds.pos.x) {                             // 1)
+        src_offset.x = bounds.pos.x - pos.x;
+        size.x -= src_offset.x;
+        pos.x = bounds.pos.x;
     }
-    for (int dy = 1; dy < size.y - 1; ++dy) {
-        writer.Write(pos.x, pos.y + dy, c);
-        writer.Write(pos.x + size.x - 1, pos.y + dy, c);
+    if (pos.y < bounds.pos.y) {
+        src_offset.y = bounds.pos.y - pos.y;
+        size.y -= src_offset.y;
+        pos.y = bounds.pos.y;
     }
+    if (pos.x + size.x > bounds.pos.x + bounds.size.x) {    // 2)
+        size.x = bounds.pos.x + bounds.size.x - pos.x;
+    }
+    if (pos.y + size.y > bounds.pos.y + bounds.size.y) {
+        size.y = bounds.pos.y + bounds.size.y - pos.y;
+    }
+    return size.x > 0 && size.y > 0;                        // 3)
 }
 
+/*
+ * 동작방식:
+ * 	1) 영역 왼쪽/위쪽으로 벗어난 만큼 시작 위치를 옮기고, 원본에서 건너뛸 양을 src_offset에 기록한다.
+ * 	2) 영역 오른쪽/아래쪽으로 벗어난 만큼 크기를 줄인다.
+ * 	3) 남은 영역이 없다면 false를 반환하여 아무것도 그리지 않게 한다.
+ *
+ * 잘라내기는 픽셀마다가 아니라 도형마다 한 번만 수행된다.
+ *
+ */
+
 
-void paintCircle(
-    PixelWriter& writer, const Vector2D<int>& center,
-    int radius, const PixelColor& c
+
+bool ClipMove(Vector2D<int>& dst_pos, Rectangle<int>& src, int width, int height) {
+    return ClipMove(dst_pos, src, {{0, 0}, {width, height}});
+}
+
+bool ClipMove(Vector2D<int>& dst_pos, Rectangle<int>& src, const Rectangle<int>& bounds) {
+    Vector2D<int> offset;
+    if (!ClipRectangle(src.pos, src.size, offset, bounds)) {                   // 1)
+        return false;
+    }
+    dst_pos += offset;
+
+    if (!ClipRectangle(dst_pos, src.size, offset, bounds)) {                   // 2)
+        return false;
+    }
+    src.pos += offset;
+    return true;
+}
+
+/*
+ * 동작방식:
+ * 	1) 원본을 먼저 잘라내고, 잘려나간 만큼 대상 위치도 함께 옮긴다.
+ * 	2) 대상을 잘라내고, 잘려나간 만큼 원본 위치도 함께 옮긴다. 크기는 두 영역이 공유한다.
+ *
+ */
+
+
+bool FrameBufferWriter::ClipToScreen(
+    Vector2D<int>& pos, Vector2D<int>& size, Vector2D<int>& src_offset
+) const {
+    return ClipRectangle(pos, size, src_offset, ClipRect());
+}
+
+void FrameBufferWriter::WriteRect32(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const uint32_t* src, int src_stride
 ) {
-    int x = radius;
-    int y = 0;
-    int err = 0;
-
-    while (x >= y) {
-        // 현재 위치와 대칭된 위치에 대해 원을 그린다.
-        writer.Write(center.x + x, center.y - y, c);
-        writer.Write(center.x + y, center.y - x, c);
-        writer.Write(center.x - y, center.y - x, c);
-        writer.Write(center.x - x, center.y - y, c);
-        writer.Write(center.x - x, center.y + y, c);
-        writer.Write(center.x - y, center.y + x, c);
-        writer.Write(center.x + y, center.y + x, c);
-        writer.Write(center.x + x, center.y + y, c);
-
-        y += 1;
-        if (err <= 0) {
-            err += 2*y + 1;
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipToScreen(p, s, offset)) {
+        return;
+    }
+
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        CopyPixels32(PixelAt32(p.x, p.y + dy), src + src_stride * dy, s.x, StoreHint::kStreaming);
+    }
+}
+
+void FrameBufferWriter::WriteRect32ColorKey(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const uint32_t* src, int src_stride, uint32_t key
+) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipToScreen(p, s, offset)) {
+        return;
+    }
+
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        CopyPixels32ColorKey(PixelAt32(p.x, p.y + dy), src + src_stride * dy, s.x, key, StoreHint::kStreaming);
+    }
+}
+
+void FrameBufferWriter::BlendRect32(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    const uint32_t* src, int src_stride, uint8_t opacity, bool src_has_alpha
+) {
+    if (!CanBlend()) {
+        WriteRect32(pos, size, src, src_stride);
+        return;
+    }
+
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipToScreen(p, s, offset)) {
+        return;
+    }
+
+    src += src_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        BlendPixels32(PixelAt32(p.x, p.y + dy), src + src_stride * dy, s.x, opacity, src_has_alpha);
+    }
+}
+
+void FrameBufferWriter::ReadRect32(
+    const Vector2D<int>& pos, const Vector2D<int>& size,
+    uint32_t* dst, int dst_stride
+) {
+    Vector2D<int> p = pos, s = size, offset;
+    if (!ClipRectangle(p, s, offset, Width(), Height())) {
+        return;
+    }
+
+    dst += dst_stride * offset.y + offset.x;
+    for (int dy = 0; dy < s.y; ++dy) {
+        CopyPixels32(dst + dst_stride * dy, PixelAt32(p.x, p.y + dy), s.x);
+    }
+}
+
+void FrameBufferWriter::MoveRect(const Vector2D<int>& dst_pos, const Rectangle<int>& src) {
+    Vector2D<int> dst = dst_pos;
+    Rectangle<int> from = src;
+    if (!ClipMove(dst, from, ClipRect())) {
+        return;
+    }
+
+    const size_t bytes = sizeof(uint32_t) * from.size.x;
+    if (dst.y <= from.pos.y) {
+        for (int dy = 0; dy < from.size.y; ++dy) {
+            memmove(PixelAt32(dst.x, dst.y + dy), PixelAt32(from.pos.x, from.pos.y + dy), bytes);
         }
-        if (err > 0) {
-            x -= 1;
-            err -= 2*x + 1;
+    } else {
+        for (int dy = from.size.y - 1; dy >= 0; --dy) {
+            memmove(PixelAt32(dst.x, dst.y + dy), PixelAt32(from.pos.x, from.pos.y + dy), bytes);
         }
     }
 }
 
+/*
+ * 프레임 버퍼 형식의 픽셀을 변환 없이 줄 단위로 복사한다. 
+ * 각 줄은 CopyPixels32()로 한 번에 복사되며, 프레임 버퍼에 쓰는 긴 줄은 non-temporal 저장(kStreaming)을 사용한다.
+ * ReadRect32()의 목적지는 일반 메모리이므로 캐시를 거쳐 저장한다.
+ * clip 영역은 그리기에만 적용되므로, ReadRect32()는 clip 영역이 아닌 화면 전체를 기준으로 잘라낸다.
+ *
+ * MoveRect()는 위로 옮길 때는 위쪽 줄부터, 아래로 옮길 때는 아래쪽 줄부터 복사하여 
+ * 아직 옮기지 않은 줄을 덮어쓰지 않는다. 같은 줄 안의 겹침은 memmove()가 처리한다.
+ *
+ * ReadRect32()와 MoveRect()는 프레임 버퍼를 읽으므로 느리다. ReadRect32()는 BackBuffer를 처음 만들 때 한 번만 사용한다.
+ * BlendRect32()도 프레임 버퍼를 읽어야 하므로, 반투명한 창은 BackBuffer 위에서 합성하는 것이 좋다.
+ *
+ */
+
+
+void paintRectangle(
+    PixelWriter& writer, const Vector2D<int>& pos,
+    const Vector2D<int>& size, const PixelColor& c
+) {
+    if (size.x <= 0 || size.y <= 0) {
+        return;
+    }
+    writer.FillSpan(pos.x, pos.y, size.x, c);
+    writer.FillSpan(pos.x, pos.y + size.y - 1, size.x, c);
+    writer.FillRect({pos.x, pos.y + 1}, {1, size.y - 2}, c);
+    writer.FillRect({pos.x + size.x - 1, pos.y + 1}, {1, size.y - 2}, c);
+}
 
 
 void fillRectangle(
     PixelWriter& writer, const Vector2D<int>& pos,
     const Vector2D<int>& size, const PixelColor& c
 ) {
-    for (int dy = 0; dy < size.y; ++dy) {
-        for (int dx = 0; dx < size.x; ++dx) {
-            writer.Write(pos.x + dx, pos.y + dy, c);
+    writer.FillRect(pos, size, c);
+}
+
+
+
+namespace {
+    const int kFixedShift = 8;                              // 좌표는 1/256 픽셀 단위의 고정 소수점이다.
+    const int32_t kFixedOne = 1 << kFixedShift;
+    const int32_t kFixedHalf = kFixedOne / 2;
+    const int kSamplesAA = 4;                               // 안티에일리어싱할 때 한 픽셀 줄을 나누는 가로줄의 수
+    const int kMaxSpans = kMaxPolygonPoints / 2;            // 가로줄 하나에서 도형이 만드는 구간의 최대 개수
+
+    struct Span {
+        int32_t left, right;                                // [left, right), 고정 소수점
+    };
+
+    int32_t ToFixed(int v) {  return v * kFixedOne;  }
+    int CeilPixel(int32_t v) {  return (v + kFixedOne - 1) >> kFixedShift;  }
+    int FloorPixel(int32_t v) {  return v >> kFixedShift;  }
+
+    uint64_t ISqrt(uint64_t n) {
+        uint64_t root = 0;
+        uint64_t bit = uint64_t{1} << 62;
+        while (bit > n) {
+            bit >>= 2;
+        }
+        while (bit != 0) {
+            if (n >= root + bit) {
+                n -= root + bit;
+                root = (root >> 1) + bit;
+            } else {
+                root >>= 1;
+            }
+            bit >>= 2;
+        }
+        return root;
+    }
+
+    void EmitRun(
+        PixelWriter& writer, const Rectangle<int>& clip,
+        int x, int y, int length, const PixelColor& c, uint8_t alpha
+    ) {
+        const int left = std::max(x, clip.pos.x);
+        const int right = std::min(x + length, clip.pos.x + clip.size.x);
+        if (left >= right || alpha == 0) {
+            return;
+        }
+        if (alpha == 255) {
+            writer.FillSpan(left, y, right - left, c);
+        } else {
+            writer.BlendSpan(left, y, right - left, c, alpha);
         }
     }
+
+    void EmitCoverageRow(
+        PixelWriter& writer, const Rectangle<int>& clip,
+        int y, const Span* spans, int count, const PixelColor& c
+    ) {
+        int edges[2 * kMaxSpans * kSamplesAA];                                      // 1)
+        int num_edges = 0;
+        for (int i = 0; i < count; ++i) {
+            edges[num_edges++] = FloorPixel(spans[i].left);
+            edges[num_edges++] = FloorPixel(spans[i].right - 1);
+        }
+        std::sort(edges, edges + num_edges);
+        num_edges = std::unique(edges, edges + num_edges) - edges;
+
+        int run_x = 0, run_length = 0;
+        uint8_t run_alpha = 0;
+        auto put = [&](int x, int length, uint8_t alpha) {                          // 4)
+            if (run_length > 0 && run_alpha == alpha && run_x + run_length == x) {
+                run_length += length;
+                return;
+            }
+            EmitRun(writer, clip, run_x, y, run_length, c, run_alpha);
+            run_x = x;
+            run_length = length;
+            run_alpha = alpha;
+        };
+
+        for (int e = 0; e < num_edges; ++e) {
+            if (e > 0 && edges[e - 1] + 1 < edges[e]) {                             // 2)
+                const int32_t mid = ToFixed(edges[e - 1] + 1) + kFixedHalf;
+                int covered = 0;
+                for (int i = 0; i < count; ++i) {
+                    covered += spans[i].left <= mid && mid < spans[i].right;
+                }
+                put(edges[e - 1] + 1, edges[e] - edges[e - 1] - 1, covered * 255 / kSamplesAA);
+            }
+
+            const int32_t pixel_left = ToFixed(edges[e]);                           // 3)
+            const int32_t pixel_right = pixel_left + kFixedOne;
+            int32_t area = 0;
+            for (int i = 0; i < count; ++i) {
+                const int32_t overlap = std::min(spans[i].right, pixel_right) - std::max(spans[i].left, pixel_left);
+                area += std::max(overlap, 0);
+            }
+            put(edges[e], 1, std::min(area * 255 / (kFixedOne * kSamplesAA), 255));
+        }
+        put(0, 0, 0);
+    }
+
+    /*
+     * 안티에일리어싱할 때, kSamplesAA개의 가로줄이 만든 구간들로 한 픽셀 줄을 그리는 함수이다.
+     *
+     * 동작방식:
+     *  1) 구간의 양 끝이 걸쳐있는 픽셀(가장자리 픽셀)을 모아 정렬한다. 
+     *     볼록한 도형이라면 한 줄에 최대 8개이다.
+     *
+     *  2) 두 가장자리 픽셀 사이의 픽셀에는 구간의 끝이 없으므로, 모든 픽셀이 같은 수의 가로줄에 덮인다.
+     *     가운데 한 점만 검사하여 한 번에 채운다. (도형의 안쪽은 대부분 여기서 FillSpan() 한 번으로 채워진다)
+     *
+     *  3) 가장자리 픽셀은 각 구간과 겹치는 길이를 더하여 덮인 비율(알파)을 구한다.
+     *
+     *  4) 알파가 같은 이웃 픽셀은 하나의 구간으로 합쳐서 그린다.
+     *
+     */
+
+    template <typename Shape>
+    void Rasterize(
+        PixelWriter& writer, int top, int bottom,
+        const PixelColor& c, bool antialias, const Shape& shape
+    ) {
+        const Rectangle<int> clip = writer.ClipRect();                              // 1)
+        top = std::max(top, clip.pos.y);
+        bottom = std::min(bottom, clip.pos.y + clip.size.y);
+
+        Span spans[kMaxSpans * kSamplesAA];
+        for (int y = top; y < bottom; ++y) {
+            if (!antialias) {                                                       // 2)
+                const int count = shape(ToFixed(y) + kFixedHalf, spans);
+                for (int i = 0; i < count; ++i) {
+                    const int left = CeilPixel(spans[i].left - kFixedHalf);
+                    const int right = CeilPixel(spans[i].right - kFixedHalf);
+                    EmitRun(writer, clip, left, y, right - left, c, 255);
+                }
+                continue;
+            }
+
+            int count = 0;                                                          // 3)
+            for (int s = 0; s < kSamplesAA; ++s) {
+                count += shape(ToFixed(y) + (2 * s + 1) * kFixedOne / (2 * kSamplesAA), spans + count);
+            }
+            EmitCoverageRow(writer, clip, y, spans, count, c);
+        }
+    }
+
+    /*
+     * 도형을 가로줄(span) 단위로 그리는 scanline rasterizer이다.
+     * shape(y, spans)는 높이 y(고정 소수점)의 가로줄이 도형 안에 있는 구간을 spans에 쓰고 그 개수를 반환한다.
+     *
+     * 동작방식:
+     *  1) clip 영역 밖의 줄은 도형마다 한 번만 잘라낸다. 구간도 clip 영역의 폭으로 잘라서 그린다.
+     *
+     *  2) 픽셀 가운데를 지나는 가로줄 하나로 구간을 구하고, 가운데가 구간 안에 있는 픽셀을 
+     *     FillSpan()으로 한 번에 채운다. 구간의 오른쪽 끝은 포함하지 않으므로, 맞닿은 두 도형이 
+     *     같은 픽셀을 두 번 칠하지 않는다.
+     *
+     *  3) 한 픽셀 줄을 kSamplesAA개의 가로줄로 나누어 구간을 모은 뒤 EmitCoverageRow()로 그린다.
+     *
+     * PLUS:
+     *  픽셀마다 도형 안인지 검사하던 방식은 (도형의 넓이)만큼의 검사와 Write() 호출이 필요하지만,
+     *  이 방식은 줄마다 구간의 끝만 계산하므로 (도형의 높이)만큼의 계산과 FillSpan() 호출로 끝난다.
+     *  FillSpan()은 LayoutPixelWriter, BackBuffer에서 FillPixels32()로 한 줄을 한 번에 채운다.
+     *
+     */
+
+    class EllipseShape {
+        public:
+            EllipseShape(const Vector2D<int>& center, int radiusX, int radiusY, bool outline)
+                : cx_{ToFixed(center.x) + kFixedHalf}, cy_{ToFixed(center.y) + kFixedHalf},
+                  rx_{ToFixed(radiusX) + kFixedHalf}, ry_{ToFixed(radiusY) + kFixedHalf},
+                  outline_{outline} {}
+
+            int operator()(int32_t y, Span* spans) const {
+                const int32_t outer = halfWidth(rx_, ry_, y - cy_);
+                if (outer < 0) {
+                    return 0;
+                }
+                const int32_t inner = outline_ ? halfWidth(rx_ - kFixedOne, ry_ - kFixedOne, y - cy_) : -1;
+                if (inner < 0) {
+                    spans[0] = {cx_ - outer, cx_ + outer};
+                    return 1;
+                }
+                spans[0] = {cx_ - outer, cx_ - inner};
+                spans[1] = {cx_ + inner, cx_ + outer};
+                return 2;
+            }
+
+        private:
+            static int32_t halfWidth(int32_t rx, int32_t ry, int32_t dy) {
+                if (rx <= 0 || ry <= 0 || dy <= -ry || dy >= ry) {
+                    return -1;
+                }
+                const int64_t root = ISqrt(static_cast<int64_t>(ry) * ry - static_cast<int64_t>(dy) * dy);
+                return static_cast<int32_t>(rx * root / ry);
+            }
+
+            const int32_t cx_, cy_, rx_, ry_;
+            const bool outline_;
+    };
+
+    /*
+     * 중심이 (cx_, cy_)이고 반지름이 (rx_, ry_)인 타원의 구간이다.
+     * 높이 dy에서의 반폭은 rx * sqrt(ry^2 - dy^2) / ry이며, 정수 제곱근으로 계산한다.
+     * outline_이라면 반지름이 1픽셀 작은 안쪽 타원을 빼서 테두리만 남긴다.
+     *
+     */
+}
+
+
+
+void paintCircle(
+    PixelWriter& writer, const Vector2D<int>& center,
+    int radius, const PixelColor& c, bool antialias
+) {
+    paintEllipse(writer, center, radius, radius, c, antialias);
 }
 
 void fillCircle(
     PixelWriter& writer, const Vector2D<int>& center,
-    int radius, const PixelColor& c
+    int radius, const PixelColor& c, bool antialias
 ) {
-    for (int y = -radius; y <= radius; ++y) {
-        for (int x = -radius; x <= radius; ++x) {
-            if (x*x + y*y <= radius*radius) {
-                writer.Write(center.x + x, center.y + y, c);
-            }
-        }
-    }
+    fillEllipse(writer, center, radius, radius, c, antialias);
 }
 
 void paintEllipse(
     PixelWriter& writer, const Vector2D<int>& center,
-    int radiusX, int radiusY, const PixelColor& c
+    int radiusX, int radiusY, const PixelColor& c, bool antialias
 ) {
+    if (radiusX < 0 || radiusY < 0) {
+        return;
+    }
+    Rasterize(
+        writer, center.y - radiusY, center.y + radiusY + 1, c, antialias,
+        EllipseShape{center, radiusX, radiusY, true}
+    );
+}
 
-    int x = 0;
-    int y = radiusY;
-    int err = 0;
+void fillEllipse(
+    PixelWriter& writer, const Vector2D<int>& center,
+    int radiusX, int radiusY, const PixelColor& c, bool antialias
+) {
+    if (radiusX < 0 || radiusY < 0) {
+        return;
+    }
+    Rasterize(
+        writer, center.y - radiusY, center.y + radiusY + 1, c, antialias,
+        EllipseShape{center, radiusX, radiusY, false}
+    );
+}
 
-    while (radiusY * radiusY * x <= radiusX * radiusX * y) {
+/*
+ * 기존의 paintCircle(), paintEllipse()는 브레젠험 알고리즘으로 테두리의 픽셀마다 Write()를 호출했고,
+ * fillCircle()은 원에 외접하는 정사각형의 모든 픽셀을 검사했다. 
+ * 이제는 모두 Rasterize()가 줄마다 만든 구간을 FillSpan()으로 채운다.
+ *
+ */
 
-        // 현재 위치와 대칭된 위치에 대해 타원을 그린다.
-        writer.Write(center.x + x, center.y - y, c);
-        writer.Write(center.x - x, center.y - y, c);
-        writer.Write(center.x - x, center.y + y, c);
-        writer.Write(center.x + x, center.y + y, c);
 
-	x += 1;
-	if(err <= 0) {
-	    err += 2 * radiusY * radiusY * x + radiusY * radiusY;
-	}
 
-	if (err > 0) {
-            y -= 1;
-            err -= 2 * radiusX * radiusX * y + radiusX * radiusX;
-        }
+void fillRoundedRectangle(
+    PixelWriter& writer, const Vector2D<int>& pos,
+    const Vector2D<int>& size, int radius, const PixelColor& c, bool antialias
+) {
+    if (size.x <= 0 || size.y <= 0) {
+        return;
     }
+    radius = std::max(0, std::min({radius, size.x / 2, size.y / 2}));             // 1)
+    if (radius == 0) {
+        writer.FillRect(pos, size, c);
+        return;
+    }
+
+    const int32_t left = ToFixed(pos.x), right = ToFixed(pos.x + size.x);
+    const int32_t top = ToFixed(pos.y + radius), bottom = ToFixed(pos.y + size.y - radius);
+    const int32_t r = ToFixed(radius);
+
+    Rasterize(writer, pos.y, pos.y + size.y, c, antialias, [=](int32_t y, Span* spans) {
+        const int32_t dy = y < top ? top - y : (y > bottom ? y - bottom : 0);      // 2)
+        const int32_t inset = r - static_cast<int32_t>(
+            ISqrt(static_cast<int64_t>(r) * r - static_cast<int64_t>(dy) * dy)
+        );
+        spans[0] = {left + inset, right - inset};
+        return 1;
+    });
+}
 
-    err = 0;
-    x = radiusX;
-    y = 0;
+/*
+ * 동작방식:
+ * 	1) 반지름은 짧은 변의 절반을 넘지 않게 줄인다. 0이라면 일반 직사각형이다.
+ *
+ * 	2) 모서리 사분원의 중심 높이(top, bottom)를 벗어난 만큼(dy) 양쪽을 안으로 깎는다.
+ * 	   깎는 양은 r - sqrt(r^2 - dy^2)이며, 가운데 부분의 줄은 깎지 않는다.
+ *
+ */
 
-    // 같은 코드를 X와 Y값을 바꾸어 한번 더 실행
 
-    while(radiusX * radiusX * y <= radiusY * radiusY * x) {
-        
-	//현재 위치와 대칭된 위치에 대해 타원을 그린다.
-	writer.Write(center.x + x, center.y - y, c);
-        writer.Write(center.x - x, center.y - y, c);
-        writer.Write(center.x - x, center.y + y, c);
-        writer.Write(center.x + x, center.y + y, c);
 
-        y += 1;
-        if (err <= 0) {
-            err += 2 * radiusX * radiusX * y + radiusX * radiusX;
+void fillPolygon(
+    PixelWriter& writer, const Vector2D<int>* points,
+    int count, const PixelColor& c, bool antialias
+) {
+    if (count < 3 || count > kMaxPolygonPoints) {
+        return;
+    }
+
+    int top = points[0].y, bottom = points[0].y;
+    for (int i = 1; i < count; ++i) {
+        top = std::min(top, points[i].y);
+        bottom = std::max(bottom, points[i].y);
+    }
+
+    Rasterize(writer, top, bottom, c, antialias, [=](int32_t y, Span* spans) {
+        struct Crossing {
+            int32_t x;
+            int winding;
+        } crossings[kMaxPolygonPoints];
+        int num_crossings = 0;
+
+        for (int i = 0; i < count; ++i) {                                           // 1)
+            const auto& p0 = points[i];
+            const auto& p1 = points[(i + 1) % count];
+            const int32_t y0 = ToFixed(p0.y), y1 = ToFixed(p1.y);
+            if ((y0 <= y && y < y1) || (y1 <= y && y < y0)) {
+                const int64_t x = ToFixed(p0.x)
+                    + static_cast<int64_t>(y - y0) * ToFixed(p1.x - p0.x) / (y1 - y0);
+                crossings[num_crossings++] = {static_cast<int32_t>(x), y1 > y0 ? 1 : -1};
+            }
         }
-        if (err > 0) {
-            x -= 1;
-            err -= 2 * radiusY * radiusY * x + radiusY * radiusY;
+        std::sort(crossings, crossings + num_crossings, [](const Crossing& a, const Crossing& b) {
+            return a.x < b.x;
+        });
+
+        int num_spans = 0;                                                          // 2)
+        int winding = 0;
+        for (int i = 0; i < num_crossings; ++i) {
+            const int next = winding + crossings[i].winding;
+            if (winding == 0 && next != 0) {
+                spans[num_spans].left = crossings[i].x;
+            } else if (winding != 0 && next == 0) {
+                spans[num_spans].right = crossings[i].x;
+                num_spans += spans[num_spans].left < spans[num_spans].right;
+            }
+            winding = next;
         }
-    
-    }
+        return num_spans;
+    });
 }
 
+/*
+ * 동작방식:
+ * 	1) 가로줄 y가 지나는 변마다 만나는 x좌표와 변의 방향(위/아래)을 구한다. 
+ * 	   변의 아래쪽 끝점은 포함하지 않으므로, 꼭짓점에서 만나는 두 변이 두 번 세어지지 않는다.
+ * 	   수평인 변은 가로줄과 만나지 않는다.
+ *
+ * 	2) x좌표 순으로 정렬한 뒤 방향을 더해가며(winding number), 0이 아닌 구간을 도형의 안쪽으로 삼는다.
+ * 	   꼭짓점이 kMaxPolygonPoints개 이하이므로 만나는 점과 구간의 수도 그 이하이다.
+ *
+ */
+
 void DrawDesktop(PixelWriter& writer) {
     const auto width = writer.Width();
     const auto height = writer.Height();
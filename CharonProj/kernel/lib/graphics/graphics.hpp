@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include "../framebuffer/frame_buffer_config.hpp"
+#include "pixel_ops.hpp"
 
 struct PixelColor {
   uint8_t r, g, b;
@@ -39,12 +41,135 @@ inline bool operator!=(const PixelColor& lhs, const PixelColor& rhs) {
 }
 
 
+//2D vector struct 
+template <typename V>
+struct Vector2D {
+    V x, y;
+
+    //Vector의 덧셈에 대한 정리
+    template <typename U>
+    Vector2D<V>& operator += (const Vector2D<U>& rhs) {
+        x += rhs.x;
+        y += rhs.y;
+        return *this;
+    }
+    /**
+     * EX)
+     * 
+     * Vector2D<int> vec1 {1, 2};
+     * Vectir2D<float> vec2 {2.5, 3.5};
+     * vec1 += Vec2;
+     * 
+     * 
+     * -------------RESULT-------------
+     * vec1 == {3, 5}
+    */
+};
+
+
+//2D rectangle struct
+template <typename T>
+struct Rectangle {
+    Vector2D<T> pos, size;
+
+    bool IsEmpty() const {  return size.x <= 0 || size.y <= 0;  }
+    T Area() const {  return IsEmpty() ? 0 : size.x * size.y;  }
+
+    bool Contains(const Vector2D<T>& p) const {
+        return pos.x <= p.x && pos.y <= p.y && p.x < pos.x + size.x && p.y < pos.y + size.y;
+    }
+
+    bool Contains(const Rectangle<T>& rhs) const {
+        return pos.x <= rhs.pos.x && pos.y <= rhs.pos.y
+            && rhs.pos.x + rhs.size.x <= pos.x + size.x
+            && rhs.pos.y + rhs.size.y <= pos.y + size.y;
+    }
+};
+
+template <typename T>
+Rectangle<T> operator&(const Rectangle<T>& lhs, const Rectangle<T>& rhs) {
+    const T left   = std::max(lhs.pos.x, rhs.pos.x);
+    const T top    = std::max(lhs.pos.y, rhs.pos.y);
+    const T right  = std::min(lhs.pos.x + lhs.size.x, rhs.pos.x + rhs.size.x);
+    const T bottom = std::min(lhs.pos.y + lhs.size.y, rhs.pos.y + rhs.size.y);
+    if (left >= right || top >= bottom) {
+        return {{0, 0}, {0, 0}};
+    }
+    return {{left, top}, {right - left, bottom - top}};
+}
+
+template <typename T>
+Rectangle<T> operator|(const Rectangle<T>& lhs, const Rectangle<T>& rhs) {
+    if (lhs.IsEmpty()) {
+        return rhs;
+    }
+    if (rhs.IsEmpty()) {
+        return lhs;
+    }
+    const T left   = std::min(lhs.pos.x, rhs.pos.x);
+    const T top    = std::min(lhs.pos.y, rhs.pos.y);
+    const T right  = std::max(lhs.pos.x + lhs.size.x, rhs.pos.x + rhs.size.x);
+    const T bottom = std::max(lhs.pos.y + lhs.size.y, rhs.pos.y + rhs.size.y);
+    return {{left, top}, {right - left, bottom - top}};
+}
+
+/**
+ * pos에서 시작하는 size 크기의 직사각형이다.
+ *
+ * operator&:
+ *  두 직사각형이 겹치는 영역을 반환한다. 겹치지 않으면 빈 직사각형을 반환한다.
+ *
+ * operator|:
+ *  두 직사각형을 모두 포함하는 가장 작은 직사각형을 반환한다.
+*/
+
+
+bool ClipRectangle(
+    Vector2D<int>& pos, Vector2D<int>& size, Vector2D<int>& src_offset,
+    int width, int height
+);
+/*  직사각형을 (0, 0) ~ (width, height) 영역 안으로 잘라낸다. 남은 영역이 없다면 false를 반환한다.  */
+
+bool ClipRectangle(
+    Vector2D<int>& pos, Vector2D<int>& size, Vector2D<int>& src_offset,
+    const Rectangle<int>& bounds
+);
+/*  위와 같지만, bounds 영역 안으로 잘라낸다. (clip 영역)  */
+
+bool ClipMove(Vector2D<int>& dst_pos, Rectangle<int>& src, int width, int height);
+bool ClipMove(Vector2D<int>& dst_pos, Rectangle<int>& src, const Rectangle<int>& bounds);
+/*  src 영역을 dst_pos로 옮길 때, 원본과 대상이 모두 (0, 0) ~ (width, height) 또는 bounds 안에 남도록 잘라낸다.  */
+
 class PixelWriter { 	
     public:
+        static const int kMaxClipDepth = 8;
+
         virtual ~PixelWriter() = default;
         virtual void Write(int x, int y, const PixelColor& c) = 0;
+        virtual void WriteUnclipped(int x, int y, const PixelColor& c) {  Write(x, y, c);  }
         virtual int Width() const = 0;
         virtual int Height() const = 0;
+
+        virtual void FillSpan(int x, int y, int length, const PixelColor& c);
+        virtual void BlendSpan(int x, int y, int length, const PixelColor& c, uint8_t alpha);
+        virtual void FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c);
+        virtual void CopySpan(int x, int y, const PixelColor* src, int length);
+        virtual void BlitRect(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const PixelColor* src, int src_stride
+        );
+
+        virtual void Flush() {}
+
+        bool PushClip(const Rectangle<int>& rect);
+        void PopClip();
+        Rectangle<int> ClipRect() const {
+            return clip_depth_ == 0 ? Rectangle<int>{{0, 0}, {Width(), Height()}} : clips_[clip_depth_ - 1];
+        }
+
+    private:
+        Rectangle<int> clips_[kMaxClipDepth];
+        int clip_depth_{0};
 };
 
 /* ======== v0.0.2 ========= (수정 필요!)
@@ -55,6 +180,10 @@ class PixelWriter {
  * Write():
  * 	이 함수는 (x, y)형태로 주어진 좌표에 특정 색의 픽셀을 쓰는 기능을 가진 함수이다.
  *
+ * WriteUnclipped():
+ * 	Write()와 같지만 (x, y)가 ClipRect() 안에 있는지 검사하지 않는다. 글리프처럼 그릴 범위를
+ * 	미리 clip 영역으로 잘라둔 안쪽 루프에서 픽셀마다 ClipRect()를 다시 구하지 않도록 사용한다.
+ *
  * PixelAt():
  * 	이 함수는 주어진 좌표(x, y)에 대한 픽셀의 포인터를 반환한다. 따라서 이 함수를 통해 
  * 	디스플레이 버퍼에 접근하여 픽셀을 쓸 수 있다. 
@@ -64,9 +193,136 @@ class PixelWriter {
  * 	PixelWriter에 FrameBuffer과 관련된 정보를 전달한다. 
  *
  *
+ * ======== 여러 픽셀을 한 번에 쓰는 함수 ========
+ *
+ * FillSpan():
+ * 	(x, y)부터 오른쪽으로 length개의 픽셀을 같은 색으로 채운다.
+ *
+ * BlendSpan():
+ * 	FillSpan()과 같지만, 기존 픽셀 위에 alpha / 255의 불투명도로 겹친다. (안티에일리어싱된 가장자리)
+ * 	기존 픽셀을 읽을 수 없는 PixelWriter의 기본 구현은 alpha가 128 이상일 때만 FillSpan()으로 채운다.
+ *
+ * FillRect():
+ * 	pos에서 시작하는 size 크기의 직사각형을 같은 색으로 채운다.
+ *
+ * CopySpan():
+ * 	(x, y)부터 오른쪽으로 src 배열의 픽셀 length개를 복사한다.
+ *
+ * BlitRect():
+ * 	한 줄에 src_stride개의 픽셀이 저장된 src 배열에서 size 크기만큼을 pos 위치로 복사한다.
+ *
+ * 	기본 구현은 Write()를 반복 호출하므로 모든 PixelWriter에서 동작한다. 
+ * 	LayoutPixelWriter는 이 함수들을 재정의하여 픽셀 형식에 맞게 
+ * 	32비트 단위로 한 줄씩 기록한다. 도형을 그리는 함수는 가능하면 이 함수들을 사용한다.
+ *
+ * Flush():
+ * 	지금까지 그린 내용을 화면에 반영한다. 프레임 버퍼에 직접 쓰는 PixelWriter는 
+ * 	아무것도 하지 않으며, BackBuffer(back_buffer.hpp)는 변경된 영역을 프레임 버퍼로 복사한다.
+ *
+ *
+ * ======== clip 영역 ========
+ *
+ * PushClip():
+ * 	현재 clip 영역과 rect가 겹치는 영역을 새 clip 영역으로 쌓는다. 이후의 모든 그리기는 이 영역 밖을 
+ * 	건드리지 않는다. kMaxClipDepth단계를 넘으면 쌓지 않고 false를 반환한다.
+ *
+ * PopClip():
+ * 	마지막으로 쌓은 clip 영역을 꺼내 이전 영역으로 되돌린다.
+ *
+ * ClipRect():
+ * 	현재 clip 영역을 반환한다. 아무것도 쌓지 않았다면 (0, 0) ~ (Width(), Height()) 전체이다.
+ *
+ * 	clip 영역은 픽셀마다가 아니라 그리기 함수(직사각형, 한 줄, 도형, 글자)마다 한 번 교차하여 적용한다.
+ * 	잘라낸 뒤의 안쪽 루프는 범위를 다시 검사하지 않으며, 완전히 밖에 있는 도형은 아무 일도 하지 않는다.
+ *
  * */
 
-class FrameBufferWriter : public PixelWriter {
+class ClipGuard {
+    public:
+        ClipGuard(PixelWriter& writer, const Rectangle<int>& rect)
+            : writer_{writer}, pushed_{writer.PushClip(rect)} {}
+        ~ClipGuard() {
+            if (pushed_) {
+                writer_.PopClip();
+            }
+        }
+        ClipGuard(const ClipGuard&) = delete;
+        ClipGuard& operator=(const ClipGuard&) = delete;
+
+    private:
+        PixelWriter& writer_;
+        const bool pushed_;
+};
+
+/*
+ * 생성할 때 PushClip()을, 소멸할 때 PopClip()을 호출하여 블록 안에서만 clip 영역을 좁힌다.
+ *
+ * EX)
+ * 	{
+ * 	    ClipGuard clip{writer, {{x, y}, {w, h}}};
+ * 	    DrawSomething(writer);                      // (x, y, w, h) 밖은 그려지지 않는다.
+ * 	}
+ *
+ * */
+
+
+class NativePixelWriter : public PixelWriter {
+    public:
+        virtual uint32_t Encode(const PixelColor& c) const = 0;
+        virtual bool CanBlend() const = 0;
+
+        virtual void BlendSpan(int x, int y, int length, const PixelColor& c, uint8_t alpha) override;
+
+        virtual void WriteRect32(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride
+        ) = 0;
+        virtual void WriteRect32ColorKey(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride, uint32_t key
+        ) = 0;
+        virtual void BlendRect32(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride, uint8_t opacity, bool src_has_alpha
+        ) = 0;
+
+        virtual void MoveRect(const Vector2D<int>& dst_pos, const Rectangle<int>& src) = 0;
+};
+
+/*
+ * NativePixelWriter:
+ * 	프레임 버퍼와 같은 32비트 픽셀 형식으로 픽셀을 저장하는 PixelWriter이다. 
+ * 	(FrameBufferWriter, BackBuffer)
+ *
+ * Encode():
+ * 	PixelColor를 프레임 버퍼에 저장되는 32비트 픽셀 값으로 변환한다.
+ *
+ * CanBlend():
+ * 	픽셀 형식이 8:8:8(하위 24비트)이라서 상위 8비트를 알파로 쓰고 BlendPixels32()로 섞을 수 있는지의 여부이다.
+ * 	false라면 BlendRect32()는 opacity를 무시하고 불투명하게 복사하며, BlendSpan()은 alpha가 128 이상일 때만 채운다.
+ *
+ * WriteRect32():
+ * 	이미 Encode()로 변환된 픽셀을 변환 없이 줄 단위로 복사한다.
+ *
+ * WriteRect32ColorKey():
+ * 	WriteRect32()와 같지만, key와 같은 픽셀은 복사하지 않는다. (투명색 처리)
+ *
+ * BlendRect32():
+ * 	premultiplied alpha 픽셀을 기존 픽셀 위에 겹친다. 자세한 내용은 pixel_ops.hpp의 BlendPixels32()를 참고한다.
+ *
+ * MoveRect():
+ * 	같은 화면 안에서 src 영역의 픽셀을 dst_pos로 옮긴다. 두 영역은 겹쳐도 된다. (스크롤)
+ *
+ * BlendSpan():
+ * 	색을 Encode()한 뒤 BlendRect32()로 겹친다. 채널 조건은 BlendPixels32()와 같다.
+ *
+ * Window는 픽셀을 미리 이 형식으로 저장해두므로, 창을 그릴 때 픽셀마다 변환할 필요 없이 
+ * 줄마다 메모리 복사 한 번으로 끝난다.
+ *
+ * */
+
+
+class FrameBufferWriter : public NativePixelWriter {
     public:
         FrameBufferWriter(const FrameBufferConfig& config) : config_{config} {}
 
@@ -74,12 +330,38 @@ class FrameBufferWriter : public PixelWriter {
         virtual int Width() const override {  return config_.horizontal_resolution;  }
         virtual int Height() const override {  return config_.vertical_resolution;  }
 
+        /*  이미 프레임 버퍼 형식으로 변환된 픽셀을 그대로 복사해 넣거나 읽어온다.  */
+        virtual void WriteRect32(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride
+        ) override;
+        virtual void WriteRect32ColorKey(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride, uint32_t key
+        ) override;
+        virtual void BlendRect32(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const uint32_t* src, int src_stride, uint8_t opacity, bool src_has_alpha
+        ) override;
+        virtual void MoveRect(const Vector2D<int>& dst_pos, const Rectangle<int>& src) override;
+        void ReadRect32(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            uint32_t* dst, int dst_stride
+        );
+
 
     protected:
         uint8_t* PixelAt(int x, int y) {
             return config_.frame_buffer + 4 * (config_.pixels_per_scan_line * y + x);
         }
 
+        uint32_t* PixelAt32(int x, int y) {
+            return reinterpret_cast<uint32_t*>(PixelAt(x, y));
+        }
+
+        /*  직사각형을 화면(현재 clip 영역) 안으로 잘라낸다. 밖이라면 false를 반환한다.  */
+        bool ClipToScreen(Vector2D<int>& pos, Vector2D<int>& size, Vector2D<int>& src_offset) const;
+
 
     private:
         const FrameBufferConfig& config_;
@@ -87,57 +369,232 @@ class FrameBufferWriter : public PixelWriter {
 
 
 
+/* ======== 픽셀 형식 기술자 ======== */
 
-class RGBResv8BitPerColorPixelWriter : public FrameBufferWriter {
-    public:
-        using FrameBufferWriter::FrameBufferWriter;
-    virtual void Write(int x, int y, const PixelColor& c) override;
+struct ChannelEncoding {
+    uint8_t down;               // 8비트 색상 값을 오른쪽으로 미는 양 (채널이 8비트보다 좁을 때)
+    uint8_t up;                 // 그 결과를 왼쪽으로 미는 양 (채널의 비트 위치)
 };
 
-class BGRResv8BitPerColorPixelWriter : public FrameBufferWriter {
-    public:
-        using FrameBufferWriter::FrameBufferWriter;
-    virtual void Write(int x, int y, const PixelColor& c) override;
-};
+constexpr int MaskShift(uint32_t mask) {
+    int shift = 0;
+    while (mask != 0 && (mask & 1u) == 0) {
+        mask >>= 1;
+        ++shift;
+    }
+    return shift;
+}
 
+constexpr int MaskBits(uint32_t mask) {
+    mask >>= MaskShift(mask);
+    int bits = 0;
+    while (mask & 1u) {
+        mask >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+constexpr ChannelEncoding MakeChannelEncoding(uint32_t mask) {
+    const int shift = MaskShift(mask);
+    const int bits = MaskBits(mask);
+    if (bits >= 8) {
+        return ChannelEncoding{0, static_cast<uint8_t>(shift + bits - 8)};
+    }
+    return ChannelEncoding{static_cast<uint8_t>(8 - bits), static_cast<uint8_t>(shift)};
+}
+
+constexpr uint32_t EncodeChannel(uint8_t value, ChannelEncoding e) {
+    return (static_cast<uint32_t>(value) >> e.down) << e.up;
+}
+
+constexpr bool IsBlendableLayout(uint32_t red, uint32_t green, uint32_t blue) {
+    auto byte_channel = [](uint32_t mask) {
+        return mask == 0x000000ffu || mask == 0x0000ff00u || mask == 0x00ff0000u;
+    };
+    return byte_channel(red) && byte_channel(green) && byte_channel(blue)
+        && (red | green | blue) == 0x00ffffffu;
+}
 
 /*
- * 위의 두 클래스는 각각 PixelWriter를 상속한 클래스로, 첫 번째 클래스는 
- * RGB형식으로 정의된 픽셀에 대한 쓰기 작업을 수행하는 클래스이며, 두 번째 클래스는 
- * BGR형식으로 정의된 필셀에 대한 쓰기 작업을 수행하는 클래스이다. 
+ * GOP가 알려주는 색상 마스크(예: 0x00ff0000)를 "몇 비트 버리고, 몇 비트 위치로 옮길지"로 바꾼다.
+ * 
+ * MaskShift():
+ * 	마스크의 가장 낮은 1 비트의 위치를 구한다.
  *
- * 왜 RGB형식과 BGR형식에 관해서 따로 클래스를 정의하는지에 대한 이유는 
- * frame_buffer_config.hpp의 frame_buffer관련 주석에 설명되어 있다.
+ * MaskBits():
+ * 	마스크에서 연속된 1 비트의 개수(채널의 폭)를 구한다.
+ *
+ * MakeChannelEncoding():
+ * 	채널이 8비트보다 좁으면(예: 5비트) 색상 값의 하위 비트를 버리고, 
+ * 	넓으면(예: 10비트) 상위 비트에 맞추어 왼쪽으로 더 민다. 마스크가 0이면 항상 0이 된다.
+ *
+ * EncodeChannel():
+ * 	8비트 색상 값 하나를 채널 위치로 옮긴다. 시프트 두 번으로 끝난다.
+ *
+ * IsBlendableLayout():
+ * 	세 채널이 하위 24비트의 서로 다른 바이트를 하나씩 차지하는지 확인한다. (RGB, BGR 형식)
+ * 	BlendPixels32(), LerpPixels32()는 이 형식만 다룰 수 있으며, 상위 8비트를 알파로 사용한다.
  *
  * */
 
 
+template <uint32_t RedMask, uint32_t GreenMask, uint32_t BlueMask>
+struct StaticPixelLayout {
+    static constexpr ChannelEncoding kRed = MakeChannelEncoding(RedMask);
+    static constexpr ChannelEncoding kGreen = MakeChannelEncoding(GreenMask);
+    static constexpr ChannelEncoding kBlue = MakeChannelEncoding(BlueMask);
 
-//2D vector struct 
-template <typename V>
-struct Vector2D {
-    V x, y;
+    static bool Matches(const PixelBitmask& mask) {
+        return mask.red_mask == RedMask && mask.green_mask == GreenMask && mask.blue_mask == BlueMask;
+    }
 
-    //Vector의 덧셈에 대한 정리
-    template <typename U>
-    Vector2D<V>& operator += (const Vector2D<U>& rhs) {
-        x += rhs.x;
-        y += rhs.y;
-        return *this;
+    static constexpr bool Blendable() {  return IsBlendableLayout(RedMask, GreenMask, BlueMask);  }
+
+    uint32_t Encode(const PixelColor& c) const {
+        return EncodeChannel(c.r, kRed) | EncodeChannel(c.g, kGreen) | EncodeChannel(c.b, kBlue);
     }
-    /**
-     * EX)
-     * 
-     * Vector2D<int> vec1 {1, 2};
-     * Vectir2D<float> vec2 {2.5, 3.5};
-     * vec1 += Vec2;
-     * 
-     * 
-     * -------------RESULT-------------
-     * vec1 == {3, 5}
-    */
 };
 
+struct DynamicPixelLayout {
+    explicit DynamicPixelLayout(const PixelBitmask& mask)
+        : red{MakeChannelEncoding(mask.red_mask)},
+          green{MakeChannelEncoding(mask.green_mask)},
+          blue{MakeChannelEncoding(mask.blue_mask)},
+          blendable{IsBlendableLayout(mask.red_mask, mask.green_mask, mask.blue_mask)} {}
+
+    uint32_t Encode(const PixelColor& c) const {
+        return EncodeChannel(c.r, red) | EncodeChannel(c.g, green) | EncodeChannel(c.b, blue);
+    }
+
+    bool Blendable() const {  return blendable;  }
+
+    ChannelEncoding red, green, blue;
+    bool blendable;
+};
+
+using RGBResv8BitPerColorLayout = StaticPixelLayout<0x000000ff, 0x0000ff00, 0x00ff0000>;
+using BGRResv8BitPerColorLayout = StaticPixelLayout<0x00ff0000, 0x0000ff00, 0x000000ff>;
+
+/*
+ * 픽셀 형식 기술자는 Encode()로 PixelColor를 32비트 픽셀 값 하나로 만든다.
+ *
+ * StaticPixelLayout:
+ * 	마스크가 템플릿 인수이므로 모든 시프트 양이 컴파일 시간에 결정된다. 
+ * 	Encode()는 상수 시프트와 OR만 남게 되어 RGB, BGR 형식은 바이트 3개를 따로 쓰던 
+ * 	기존 코드보다 훨씬 짧은 명령어로 바뀐다.
+ *
+ * DynamicPixelLayout:
+ * 	GOP가 알려준 마스크가 미리 정의된 형식과 일치하지 않을 때 사용한다. 
+ * 	시프트 양은 부팅 시 한 번 계산되며, 그 뒤에는 StaticPixelLayout과 같은 방식으로 동작한다.
+ *
+ * Blendable():
+ * 	IsBlendableLayout()의 결과이다. 10비트 채널이나 상위 바이트를 쓰는 채널처럼 
+ * 	8:8:8 형식이 아니라면 false이며, 이때 알파 합성은 불투명한 복사로 대신한다.
+ *
+ * */
+
+
+
+template <typename Layout>
+class LayoutPixelWriter final : public FrameBufferWriter {
+    public:
+        explicit LayoutPixelWriter(const FrameBufferConfig& config, const Layout& layout = Layout{})
+            : FrameBufferWriter{config}, layout_{layout} {}
+
+        virtual uint32_t Encode(const PixelColor& c) const override {
+            return layout_.Encode(c);
+        }
+
+        virtual bool CanBlend() const override {
+            return layout_.Blendable();
+        }
+
+        virtual void Write(int x, int y, const PixelColor& c) override {
+            if (!ClipRect().Contains(Vector2D<int>{x, y})) {
+                return;
+            }
+            *PixelAt32(x, y) = layout_.Encode(c);
+        }
+
+        virtual void WriteUnclipped(int x, int y, const PixelColor& c) override {
+            *PixelAt32(x, y) = layout_.Encode(c);
+        }
+
+        virtual void FillSpan(int x, int y, int length, const PixelColor& c) override {
+            FillRect({x, y}, {length, 1}, c);
+        }
+
+        virtual void FillRect(const Vector2D<int>& pos, const Vector2D<int>& size, const PixelColor& c) override {
+            Vector2D<int> p = pos, s = size, offset;
+            if (!ClipToScreen(p, s, offset)) {
+                return;
+            }
+
+            const uint32_t value = layout_.Encode(c);
+            for (int dy = 0; dy < s.y; ++dy) {
+                FillPixels32(PixelAt32(p.x, p.y + dy), value, s.x, StoreHint::kStreaming);
+            }
+        }
+
+        virtual void CopySpan(int x, int y, const PixelColor* src, int length) override {
+            BlitRect({x, y}, {length, 1}, src, length);
+        }
+
+        virtual void BlitRect(
+            const Vector2D<int>& pos, const Vector2D<int>& size,
+            const PixelColor* src, int src_stride
+        ) override {
+            Vector2D<int> p = pos, s = size, offset;
+            if (!ClipToScreen(p, s, offset)) {
+                return;
+            }
+
+            src += src_stride * offset.y + offset.x;
+            for (int dy = 0; dy < s.y; ++dy) {
+                uint32_t* row = PixelAt32(p.x, p.y + dy);
+                const PixelColor* src_row = src + src_stride * dy;
+                for (int dx = 0; dx < s.x; ++dx) {
+                    row[dx] = layout_.Encode(src_row[dx]);
+                }
+            }
+        }
+
+
+    private:
+        Layout layout_;
+};
+
+using RGBResv8BitPerColorPixelWriter = LayoutPixelWriter<RGBResv8BitPerColorLayout>;
+using BGRResv8BitPerColorPixelWriter = LayoutPixelWriter<BGRResv8BitPerColorLayout>;
+using BitmaskPixelWriter = LayoutPixelWriter<DynamicPixelLayout>;
+
+
+/*
+ * LayoutPixelWriter는 픽셀 형식 기술자(Layout)마다 따로 만들어지는 FrameBufferWriter이다.
+ * 
+ * 한 줄을 채우거나 복사하는 안쪽 루프는 layout_.Encode()를 직접 호출하므로, 
+ * 가상 함수 호출이나 픽셀 형식에 따른 분기 없이 픽셀마다 32비트 저장 한 번으로 끝난다.
+ * 가상 함수 호출은 도형(직사각형, 한 줄)마다 한 번만 발생한다.
+ *
+ * RGBResv8BitPerColorPixelWriter:
+ * 	RGB형식으로 정의된 픽셀에 대한 쓰기 작업을 수행한다.
+ *
+ * BGRResv8BitPerColorPixelWriter:
+ * 	BGR형식으로 정의된 픽셀에 대한 쓰기 작업을 수행한다.
+ *
+ * BitmaskPixelWriter:
+ * 	GOP가 PixelBitMask 형식을 알려주었을 때, 그 마스크를 따라 픽셀을 쓴다.
+ *
+ * 왜 RGB형식과 BGR형식에 관해서 따로 클래스를 정의하는지에 대한 이유는 
+ * frame_buffer_config.hpp의 frame_buffer관련 주석에 설명되어 있다.
+ *
+ * 예약 비트는 항상 0으로 기록된다.
+ *
+ * */
+
+
+
 //paint func
 void paintRectangle(
     PixelWriter& writer, const Vector2D<int>& pos,
@@ -151,17 +608,34 @@ void fillRectangle(
 
 void paintCircle(
     PixelWriter& writer, const Vector2D<int>& center,
-    int radius, const PixelColor& c
+    int radius, const PixelColor& c, bool antialias = false
 );
 
 void fillCircle(
     PixelWriter& writer, const Vector2D<int>& center,
-    int radius, const PixelColor& c
+    int radius, const PixelColor& c, bool antialias = false
 );
 
 void paintEllipse(
     PixelWriter& writer, const Vector2D<int>& center,
-    int radiusX, int radiusY, const PixelColor& c
+    int radiusX, int radiusY, const PixelColor& c, bool antialias = false
+);
+
+void fillEllipse(
+    PixelWriter& writer, const Vector2D<int>& center,
+    int radiusX, int radiusY, const PixelColor& c, bool antialias = false
+);
+
+void fillRoundedRectangle(
+    PixelWriter& writer, const Vector2D<int>& pos,
+    const Vector2D<int>& size, int radius, const PixelColor& c, bool antialias = false
+);
+
+const int kMaxPolygonPoints = 64;
+
+void fillPolygon(
+    PixelWriter& writer, const Vector2D<int>* points,
+    int count, const PixelColor& c, bool antialias = false
 );
 
 
@@ -183,12 +657,25 @@ void DrawDesktop(PixelWriter& writer);
  * 
  * 3. paintCircle():
  * 	위의 paintRectangle() 함수와 동일하게 기능하며, 특정 색의 픽셀로 원을 그린다.
- * 	이 함수는 브레젠험 알고리즘을 응용한 것으로 각 픽셀에 대한 직선의 근사치를 계산하여 가장 가까운 점을 그린다.
+ * 	반지름이 1픽셀 다른 두 원 사이의 고리(ring)를 가로줄(span) 단위로 채운다.
  * 
  * 4. fillCircle():
  * 	위의 fillRectangle() 함수와 동일하게 기능하며, 특정 색의 픽셀로 원 안을 채운다. 
  *
- * 5. paintEllipse();
- * 	구현 예정, 화면에 타원을 출력하는 함수이다.
+ * 5. paintEllipse(), fillEllipse():
+ * 	타원의 테두리를 그리거나 내부를 채운다. radiusX, radiusY가 같다면 paintCircle(), fillCircle()과 같다.
+ *
+ * 6. fillRoundedRectangle():
+ * 	네 모서리가 반지름 radius인 사분원으로 깎인 직사각형을 채운다. (창의 장식 등)
+ *
+ * 7. fillPolygon():
+ * 	points의 꼭짓점 count개(최대 kMaxPolygonPoints개)를 차례로 이은 다각형을 non-zero 규칙으로 채운다.
+ * 	꼭짓점은 픽셀의 왼쪽 위 모서리 좌표이므로, 직사각형 모양의 다각형은 fillRectangle()과 같은 픽셀을 칠한다.
+ *
+ * 원과 타원은 중심 픽셀의 가운데를 중심으로, 반지름에 0.5를 더한 크기로 그린다. 
+ * 따라서 (2 * radius + 1) 크기의 정사각형 안을 빈틈없이 채운다.
+ *
+ * antialias가 true라면 한 픽셀을 4개의 가로줄로 나누어 가장자리 픽셀이 도형에 덮인 비율을 구하고,
+ * 그 비율만큼 BlendSpan()으로 겹친다. 가장자리가 아닌 픽셀은 그대로 FillSpan()으로 채운다.
  *
  * */
@@ -0,0 +1,530 @@
+/**
+ * @file pixel_ops.cpp
+*/
+
+#include "pixel_ops.hpp"
+
+#include <immintrin.h>
+#include "../cpu/cpu.hpp"
+
+
+namespace {
+    /*  ======== scalar ========  */
+
+    void FillScalar(uint32_t* dst, uint32_t value, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = value;
+        }
+    }
+
+    void CopyScalar(uint32_t* dst, const uint32_t* src, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = src[i];
+        }
+    }
+
+    void CopyColorKeyScalar(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key) {
+        for (size_t i = 0; i < count; ++i) {
+            if (src[i] != key) {
+                dst[i] = src[i];
+            }
+        }
+    }
+
+
+    /*  ======== SSE2 ========  */
+
+    size_t HeadCount(const uint32_t* dst, size_t count, size_t align) {
+        const size_t misaligned = reinterpret_cast<uintptr_t>(dst) & (align - 1);
+        const size_t head = misaligned ? (align - misaligned) / sizeof(uint32_t) : 0;
+        return head < count ? head : count;
+    }
+
+    void FillSSE2(uint32_t* dst, uint32_t value, size_t count, StoreHint hint) {
+        size_t i = HeadCount(dst, count, 16);                           // 1)
+        FillScalar(dst, value, i);
+
+        const __m128i v = _mm_set1_epi32(value);
+        if (hint == StoreHint::kStreaming && count >= kNonTemporalThreshold) {                           // 2)
+            for (; i + 4 <= count; i += 4) {
+                _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), v);
+            }
+            _mm_sfence();
+        } else {
+            for (; i + 4 <= count; i += 4) {
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), v);
+            }
+        }
+
+        FillScalar(dst + i, value, count - i);                          // 3)
+    }
+
+    void CopySSE2(uint32_t* dst, const uint32_t* src, size_t count, StoreHint hint) {
+        size_t i = HeadCount(dst, count, 16);
+        CopyScalar(dst, src, i);
+
+        if (hint == StoreHint::kStreaming && count >= kNonTemporalThreshold) {
+            for (; i + 4 <= count; i += 4) {
+                const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            }
+            _mm_sfence();
+        } else {
+            for (; i + 4 <= count; i += 4) {
+                const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            }
+        }
+
+        CopyScalar(dst + i, src + i, count - i);
+    }
+
+    void CopyColorKeySSE2(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key, StoreHint hint) {
+        const __m128i k = _mm_set1_epi32(key);
+        size_t i = 0;
+        bool masked_store = false;
+
+        for (; i + 4 <= count; i += 4) {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i is_key = _mm_cmpeq_epi32(s, k);               // 4)
+            const int key_bytes = _mm_movemask_epi8(is_key);
+
+            if (key_bytes == 0xffff) {                                  // 5)
+                continue;
+            }
+            if (key_bytes == 0) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+                continue;
+            }
+            if (hint == StoreHint::kCached) {                           // 6)
+                const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(dst + i),
+                    _mm_or_si128(_mm_and_si128(is_key, d), _mm_andnot_si128(is_key, s))
+                );
+                continue;
+            }
+            const __m128i write = _mm_xor_si128(is_key, _mm_set1_epi32(-1));
+            _mm_maskmoveu_si128(s, write, reinterpret_cast<char*>(dst + i));
+            masked_store = true;
+        }
+        if (masked_store) {
+            _mm_sfence();
+        }
+
+        CopyColorKeyScalar(dst + i, src + i, count - i, key);
+    }
+
+
+    /*  ======== AVX2 ========  */
+
+    __attribute__((target("avx2")))
+    void FillAVX2(uint32_t* dst, uint32_t value, size_t count, StoreHint hint) {
+        size_t i = HeadCount(dst, count, 32);
+        FillScalar(dst, value, i);
+
+        const __m256i v = _mm256_set1_epi32(value);
+        if (hint == StoreHint::kStreaming && count >= kNonTemporalThreshold) {
+            for (; i + 8 <= count; i += 8) {
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), v);
+            }
+            _mm_sfence();
+        } else {
+            for (; i + 8 <= count; i += 8) {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), v);
+            }
+        }
+
+        FillScalar(dst + i, value, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void CopyAVX2(uint32_t* dst, const uint32_t* src, size_t count, StoreHint hint) {
+        size_t i = HeadCount(dst, count, 32);
+        CopyScalar(dst, src, i);
+
+        if (hint == StoreHint::kStreaming && count >= kNonTemporalThreshold) {
+            for (; i + 8 <= count; i += 8) {
+                const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), s);
+            }
+            _mm_sfence();
+        } else {
+            for (; i + 8 <= count; i += 8) {
+                const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), s);
+            }
+        }
+
+        CopyScalar(dst + i, src + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void CopyColorKeyAVX2(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key, StoreHint) {
+        const __m256i k = _mm256_set1_epi32(key);
+        const __m256i ones = _mm256_set1_epi32(-1);
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            const __m256i is_key = _mm256_cmpeq_epi32(s, k);
+            const int key_bytes = _mm256_movemask_epi8(is_key);
+
+            if (key_bytes == -1) {
+                continue;
+            }
+            if (key_bytes == 0) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+                continue;
+            }
+            _mm256_maskstore_epi32(                                         // 7)
+                reinterpret_cast<int*>(dst + i), _mm256_xor_si256(is_key, ones), s
+            );
+        }
+
+        CopyColorKeyScalar(dst + i, src + i, count - i, key);
+    }
+
+
+    /*  ======== 알파 블렌딩 ========  */
+
+    const uint32_t kAlphaMask = 0xff000000u;
+
+    uint32_t Div255(uint32_t x) {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    uint32_t BlendPixel(uint32_t d, uint32_t s, uint32_t opacity) {
+        uint32_t result = 0;
+        const uint32_t a = Div255((s >> 24) * opacity);
+        for (int shift = 0; shift < 24; shift += 8) {
+            const uint32_t sc = Div255(((s >> shift) & 0xffu) * opacity);
+            const uint32_t dc = Div255(((d >> shift) & 0xffu) * (255 - a));
+            result |= ((sc + dc) & 0xffu) << shift;
+        }
+        return result;
+    }
+
+    void BlendScalar(uint32_t* dst, const uint32_t* src, size_t count, uint8_t opacity, bool src_has_alpha) {
+        const uint32_t alpha_or = src_has_alpha ? 0 : kAlphaMask;
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = BlendPixel(dst[i], src[i] | alpha_or, opacity);
+        }
+    }
+
+    __m128i Div255SSE2(__m128i x) {
+        x = _mm_add_epi16(x, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    __m128i BlendHalfSSE2(__m128i d, __m128i s, __m128i opacity) {
+        s = Div255SSE2(_mm_mullo_epi16(s, opacity));                            // 1)
+        __m128i a = _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));            // 2)
+        a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+        return _mm_add_epi16(s, Div255SSE2(_mm_mullo_epi16(d, inv)));           // 3)
+    }
+
+    void BlendSSE2(uint32_t* dst, const uint32_t* src, size_t count, uint8_t opacity, bool src_has_alpha) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i op = _mm_set1_epi16(opacity);
+        const __m128i alpha_or = _mm_set1_epi32(src_has_alpha ? 0 : static_cast<int>(kAlphaMask));
+        const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(kAlphaMask));
+        const __m128i color_mask = _mm_set1_epi32(0x00ffffff);
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            const __m128i s = _mm_or_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), alpha_or
+            );
+            const int alpha_bits = _mm_movemask_epi8(                           // 4)
+                _mm_cmpeq_epi32(_mm_and_si128(s, alpha_mask), zero)
+            );
+            if (alpha_bits == 0xffff) {
+                continue;
+            }
+            if (opacity == 255 && _mm_movemask_epi8(
+                    _mm_cmpeq_epi32(_mm_and_si128(s, alpha_mask), alpha_mask)) == 0xffff) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(s, color_mask));
+                continue;
+            }
+
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            const __m128i lo = BlendHalfSSE2(
+                _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), op
+            );
+            const __m128i hi = BlendHalfSSE2(
+                _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), op
+            );
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i*>(dst + i),
+                _mm_and_si128(_mm_packus_epi16(lo, hi), color_mask)                 // 5)
+            );
+        }
+
+        BlendScalar(dst + i, src + i, count - i, opacity, src_has_alpha);
+    }
+
+    __attribute__((target("avx2")))
+    __m256i Div255AVX2(__m256i x) {
+        x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+    }
+
+    __attribute__((target("avx2")))
+    __m256i BlendHalfAVX2(__m256i d, __m256i s, __m256i opacity) {
+        s = Div255AVX2(_mm256_mullo_epi16(s, opacity));
+        __m256i a = _mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3));
+        a = _mm256_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+        return _mm256_add_epi16(s, Div255AVX2(_mm256_mullo_epi16(d, inv)));
+    }
+
+    __attribute__((target("avx2")))
+    void BlendAVX2(uint32_t* dst, const uint32_t* src, size_t count, uint8_t opacity, bool src_has_alpha) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i op = _mm256_set1_epi16(opacity);
+        const __m256i alpha_or = _mm256_set1_epi32(src_has_alpha ? 0 : static_cast<int>(kAlphaMask));
+        const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int>(kAlphaMask));
+        const __m256i color_mask = _mm256_set1_epi32(0x00ffffff);
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const __m256i s = _mm256_or_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), alpha_or
+            );
+            const __m256i alpha = _mm256_and_si256(s, alpha_mask);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, zero)) == -1) {
+                continue;
+            }
+            if (opacity == 255 && _mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, alpha_mask)) == -1) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(s, color_mask));
+                continue;
+            }
+
+            const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            const __m256i lo = BlendHalfAVX2(                                       // 6)
+                _mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero), op
+            );
+            const __m256i hi = BlendHalfAVX2(
+                _mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero), op
+            );
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i*>(dst + i),
+                _mm256_and_si256(_mm256_packus_epi16(lo, hi), color_mask)
+            );
+        }
+
+        BlendScalar(dst + i, src + i, count - i, opacity, src_has_alpha);
+    }
+
+    /*
+     * premultiplied alpha 픽셀 s를 d 위에 겹친다. 각 채널마다
+     *     s' = s * opacity / 255
+     *     out = s' + d * (255 - s'의 알파) / 255
+     * 를 계산한다. 채널 순서와 관계없이 같은 식을 사용하므로 RGB, BGR 형식 모두에서 동작한다.
+     *
+     * 동작방식:
+     *  1) 8비트 채널을 16비트로 넓힌 뒤 레이어 불투명도(opacity)를 곱한다. (알파 포함)
+     *  2) 각 픽셀의 알파(16비트 4개 중 마지막)를 네 채널 모두에 복사한다.
+     *  3) 목적지 채널에 (255 - 알파)를 곱해 더한다. 
+     *     premultiplied이므로 원본 채널에는 알파를 다시 곱할 필요가 없다.
+     *  4) 네 픽셀이 모두 완전히 투명하면 건너뛰고, 모두 불투명하고 opacity가 255라면 그대로 저장한다.
+     *     그림자나 안티에일리어싱된 가장자리처럼 일부만 반투명한 창에서는 대부분 이 두 경우에 해당한다.
+     *  5) 16비트를 다시 8비트로 줄이고, 목적지의 예약 바이트(알파 위치)는 0으로 둔다.
+     *  6) AVX2에서 unpack, pack은 128비트 단위로 동작하므로 두 연산을 함께 쓰면 픽셀 순서가 유지된다.
+     *
+     * PLUS:
+     *  Div255():
+     *      x / 255를 나눗셈 없이 (x + 128 + ((x + 128) >> 8)) >> 8로 계산한다. 
+     *      0 ~ 255*255 범위에서 반올림한 결과와 정확히 같다.
+     *
+     */
+
+
+    /*  ======== 커버리지 보간 ========  */
+
+    void LerpScalar(uint32_t* dst, const uint8_t* coverage, size_t count, uint32_t fg, uint32_t bg) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t c = coverage[i];
+            uint32_t result = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                const uint32_t f = (fg >> shift) & 0xffu, b = (bg >> shift) & 0xffu;
+                result |= Div255(f * c + b * (255 - c)) << shift;
+            }
+            dst[i] = result;
+        }
+    }
+
+    __m128i LerpHalfSSE2(__m128i c, __m128i fg, __m128i bg) {
+        const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), c);
+        return Div255SSE2(_mm_add_epi16(_mm_mullo_epi16(fg, c), _mm_mullo_epi16(bg, inv)));
+    }
+
+    void LerpSSE2(uint32_t* dst, const uint8_t* coverage, size_t count, uint32_t fg, uint32_t bg) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i fg16 = _mm_unpacklo_epi8(_mm_set1_epi32(fg), zero);
+        const __m128i bg16 = _mm_unpacklo_epi8(_mm_set1_epi32(bg), zero);
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            uint32_t bytes;
+            __builtin_memcpy(&bytes, coverage + i, sizeof(bytes));
+            __m128i c = _mm_unpacklo_epi16(                                     // 1)
+                _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero
+            );
+            c = _mm_or_si128(c, _mm_slli_epi32(c, 8));
+            c = _mm_or_si128(c, _mm_slli_epi32(c, 16));
+
+            const __m128i lo = LerpHalfSSE2(_mm_unpacklo_epi8(c, zero), fg16, bg16);    // 2)
+            const __m128i hi = LerpHalfSSE2(_mm_unpackhi_epi8(c, zero), fg16, bg16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+        }
+
+        LerpScalar(dst + i, coverage + i, count - i, fg, bg);
+    }
+
+    __attribute__((target("avx2")))
+    __m256i LerpHalfAVX2(__m256i c, __m256i fg, __m256i bg) {
+        const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), c);
+        return Div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(fg, c), _mm256_mullo_epi16(bg, inv)));
+    }
+
+    __attribute__((target("avx2")))
+    void LerpAVX2(uint32_t* dst, const uint8_t* coverage, size_t count, uint32_t fg, uint32_t bg) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i fg16 = _mm256_unpacklo_epi8(_mm256_set1_epi32(fg), zero);
+        const __m256i bg16 = _mm256_unpacklo_epi8(_mm256_set1_epi32(bg), zero);
+        const __m256i replicate = _mm256_set1_epi32(0x01010101);
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const __m256i c = _mm256_mullo_epi32(                                   // 3)
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(coverage + i))),
+                replicate
+            );
+            const __m256i lo = LerpHalfAVX2(_mm256_unpacklo_epi8(c, zero), fg16, bg16);
+            const __m256i hi = LerpHalfAVX2(_mm256_unpackhi_epi8(c, zero), fg16, bg16);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+        }
+
+        LerpScalar(dst + i, coverage + i, count - i, fg, bg);
+    }
+
+    /*
+     * 8비트 커버리지(글리프가 픽셀을 덮는 비율) c로 전경색과 배경색을 섞는다. 각 채널마다
+     *     out = (fg * c + bg * (255 - c)) / 255
+     * 를 계산한다. fg, bg는 이미 프레임 버퍼 형식으로 변환된 값이며, BlendPixels32()와 같이
+     * 채널 순서와 관계없이 바이트마다 같은 식을 사용한다. 두 곱의 합은 255 * 255를 넘지 않으므로
+     * 16비트 안에서 계산할 수 있다.
+     *
+     * 동작방식:
+     *  1) 커버리지 4바이트를 픽셀마다 32비트로 넓힌 뒤, 네 바이트에 복사하여 "커버리지 픽셀"을 만든다.
+     *
+     *  2) 커버리지 픽셀을 일반 픽셀과 같은 방법으로 16비트로 펼치므로, packus 후의 순서가 그대로 맞는다.
+     *     fg, bg는 상수이므로 목적지를 읽을 필요가 없다.
+     *
+     *  3) AVX2에서는 8바이트를 vpmovzxbd로 넓히고 0x01010101을 곱해 네 바이트에 복사한다.
+     *     unpack, pack이 128비트 단위로 동작하는 것은 BlendAVX2()와 같다.
+     *
+     */
+
+
+    using FillFunc = void (*)(uint32_t*, uint32_t, size_t, StoreHint);
+    using CopyFunc = void (*)(uint32_t*, const uint32_t*, size_t, StoreHint);
+    using CopyColorKeyFunc = void (*)(uint32_t*, const uint32_t*, size_t, uint32_t, StoreHint);
+    using BlendFunc = void (*)(uint32_t*, const uint32_t*, size_t, uint8_t, bool);
+    using LerpFunc = void (*)(uint32_t*, const uint8_t*, size_t, uint32_t, uint32_t);
+
+    void FillScalarHint(uint32_t* dst, uint32_t value, size_t count, StoreHint) {
+        FillScalar(dst, value, count);
+    }
+
+    void CopyScalarHint(uint32_t* dst, const uint32_t* src, size_t count, StoreHint) {
+        CopyScalar(dst, src, count);
+    }
+
+    void CopyColorKeyScalarHint(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key, StoreHint) {
+        CopyColorKeyScalar(dst, src, count, key);
+    }
+
+    FillFunc fill_func = FillScalarHint;
+    CopyFunc copy_func = CopyScalarHint;
+    CopyColorKeyFunc copy_color_key_func = CopyColorKeyScalarHint;
+    BlendFunc blend_func = BlendScalar;
+    LerpFunc lerp_func = LerpScalar;
+}
+
+/**
+ * @brief 각 명령어 집합별 픽셀 함수 구현
+ *
+ * 동작방식:
+ *  1) dst가 벡터 크기(16/32바이트)에 정렬될 때까지 앞부분을 scalar로 처리한다.
+ *     정렬된 저장(store, stream)은 정렬되지 않은 저장보다 빠르고, stream은 정렬이 필수이다.
+ *
+ *  2) kStreaming이고 픽셀 수가 kNonTemporalThreshold 이상이면 non-temporal 저장(movntdq)을 사용한다.
+ *     프레임 버퍼처럼 다시 읽지 않는 큰 영역을 쓸 때 캐시를 오염시키지 않고, 
+ *     쓰기 결합(write combining)으로 한 번에 캐시 라인 단위로 기록된다.
+ *     non-temporal 저장은 순서가 보장되지 않으므로 마지막에 sfence를 실행한다.
+ *
+ *  3) 벡터 크기보다 작게 남은 뒷부분을 scalar로 처리한다.
+ *
+ *  4) 원본 픽셀과 투명색을 비교하여, 투명색인 픽셀 위치의 비트가 모두 1인 마스크를 만든다.
+ *
+ *  5) 네 픽셀이 모두 투명색이면 건너뛰고, 투명색이 하나도 없다면 그대로 저장한다.
+ *     창의 대부분은 이 두 경우에 해당하므로 분기 예측이 잘 맞는다.
+ *
+ *  6) 일부만 투명색이면 maskmovdqu로 투명하지 않은 픽셀만 기록한다. 목적지(프레임 버퍼)를
+ *     읽어서 섞지 않으므로, 읽기가 느린 프레임 버퍼에서도 빠르다. 
+ *     maskmovdqu는 non-temporal 저장이므로, kCached라면 목적지를 읽어 마스크로 섞은 뒤 일반 저장을 한다.
+ *     (일반 메모리는 읽기가 빠르고, 쓴 줄이 캐시에 남는다)
+ *
+ *  7) AVX2에서는 vpmaskmovd로 같은 처리를 한다. (각 32비트 값의 최상위 비트가 쓰기 여부를 결정)
+ *
+ * PLUS:
+ *  target("avx2") 속성:
+ *      커널 전체는 AVX 없이 빌드되므로, AVX2 함수에만 속성을 붙여 해당 함수 안에서만 
+ *      AVX2 명령어를 생성하게 한다. 이 함수들은 CPUFeatures::avx2가 true일 때만 호출된다.
+ *      컴파일러는 AVX 함수가 반환할 때 vzeroupper를 넣어 SSE 코드로 돌아갈 때의 전환 비용을 없앤다.
+*/
+
+
+void InitializePixelOps() {
+    const auto& features = GetCPUFeatures();
+
+    if (features.avx2) {
+        fill_func = FillAVX2;
+        copy_func = CopyAVX2;
+        copy_color_key_func = CopyColorKeyAVX2;
+        blend_func = BlendAVX2;
+        lerp_func = LerpAVX2;
+    } else if (features.sse2) {
+        fill_func = FillSSE2;
+        copy_func = CopySSE2;
+        copy_color_key_func = CopyColorKeySSE2;
+        blend_func = BlendSSE2;
+        lerp_func = LerpSSE2;
+    }
+}
+
+
+void FillPixels32(uint32_t* dst, uint32_t value, size_t count, StoreHint hint) {
+    fill_func(dst, value, count, hint);
+}
+
+void CopyPixels32(uint32_t* dst, const uint32_t* src, size_t count, StoreHint hint) {
+    copy_func(dst, src, count, hint);
+}
+
+void CopyPixels32ColorKey(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key, StoreHint hint) {
+    copy_color_key_func(dst, src, count, key, hint);
+}
+
+void BlendPixels32(uint32_t* dst, const uint32_t* src, size_t count, uint8_t opacity, bool src_has_alpha) {
+    blend_func(dst, src, count, opacity, src_has_alpha);
+}
+
+void LerpPixels32(uint32_t* dst, const uint8_t* coverage, size_t count, uint32_t fg, uint32_t bg) {
+    lerp_func(dst, coverage, count, fg, bg);
+}
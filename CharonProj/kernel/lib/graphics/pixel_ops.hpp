@@ -0,0 +1,63 @@
+/**
+ * @file pixel_ops.hpp
+ *
+ * 32비트 픽셀 배열을 채우고 복사하는 SIMD 함수.
+ * CPU 기능에 따라 부팅 시 한 번 구현을 선택한다.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// kStreaming일 때, 이 개수 이상의 픽셀을 한 번에 쓰면 캐시를 거치지 않는 non-temporal 저장을 사용한다.
+const size_t kNonTemporalThreshold = 1024;
+
+enum class StoreHint {
+    kCached,                    // 일반 메모리 (BackBuffer, Window, 커서 평면 등 곧 다시 읽는 버퍼)
+    kStreaming,                 // 프레임 버퍼(VRAM)처럼 다시 읽지 않는 목적지
+};
+
+
+void InitializePixelOps();
+/**
+ * @brief GetCPUFeatures()를 확인하여 아래 함수들의 구현(scalar, SSE2, AVX2)을 선택한다.
+ *
+ * InitializeCPUFeatures() 이후에 호출해야 한다. 호출하기 전에는 scalar 구현이 사용된다.
+*/
+
+
+void FillPixels32(uint32_t* dst, uint32_t value, size_t count, StoreHint hint = StoreHint::kCached);
+void CopyPixels32(uint32_t* dst, const uint32_t* src, size_t count, StoreHint hint = StoreHint::kCached);
+void CopyPixels32ColorKey(
+    uint32_t* dst, const uint32_t* src, size_t count, uint32_t key, StoreHint hint = StoreHint::kCached
+);
+void BlendPixels32(uint32_t* dst, const uint32_t* src, size_t count, uint8_t opacity, bool src_has_alpha);
+void LerpPixels32(uint32_t* dst, const uint8_t* coverage, size_t count, uint32_t fg, uint32_t bg);
+/**
+ * @brief 32비트 픽셀 배열을 채우거나 복사한다.
+ *
+ * FillPixels32():
+ *  dst부터 count개의 픽셀을 value로 채운다.
+ *
+ * CopyPixels32():
+ *  src의 픽셀 count개를 dst로 복사한다. 두 영역은 겹치지 않아야 한다.
+ *
+ * CopyPixels32ColorKey():
+ *  src의 픽셀 중 key와 같지 않은 픽셀만 dst로 복사한다. (투명색 처리)
+ *
+ * BlendPixels32():
+ *  상위 8비트에 알파를 담은 premultiplied alpha 픽셀 src를 dst 위에 겹치고, 
+ *  전체에 opacity / 255를 곱한다. src_has_alpha가 false라면 src를 불투명(알파 255)으로 본다.
+ *  색상 채널은 하위 24비트의 8비트 바이트 3개여야 한다. (RGB, BGR 형식)
+ *
+ * LerpPixels32():
+ *  coverage의 8비트 값(0 ~ 255)마다 fg와 bg를 채널별로 보간하여 dst에 쓴다. 
+ *  안티에일리어싱된 글리프를 전경색, 배경색으로 펼칠 때 사용한다. 채널 조건은 BlendPixels32()와 같다.
+ *
+ * dst는 4바이트 정렬되어 있어야 한다. hint가 kStreaming이고 count가 kNonTemporalThreshold 이상이면 
+ * non-temporal 저장을 사용하며, 함수가 반환하기 전에 sfence로 저장을 완료한다. 
+ * 기본값인 kCached는 항상 캐시를 거쳐 저장한다. BackBuffer처럼 Flush()가 곧 다시 읽는 메모리에 
+ * non-temporal 저장을 사용하면, 방금 쓴 줄이 캐시에서 밀려나 다음 복사가 오히려 느려진다.
+*/
@@ -5,6 +5,12 @@
 */
 
 #include "interrupt.hpp"
+#include "interrupt_asm.h"
+#include "../sync/spinlock.hpp"
+#include "../log/logger.hpp"
+
+#include <algorithm>
+#include <cinttypes>
 
 
 struct InterruptDescriptor idt[IDT_SIZE];
@@ -77,3 +83,405 @@ void NotifyEndOfInterrupt() {
  *      1024바이트의 범위이다.
  * 
 */
+
+
+
+/**
+ * ======== 인터럽트 벡터 할당자 ========
+*/
+
+std::array<InterruptVectorEntry, IDT_SIZE> interrupt_vectors{};
+
+namespace {
+    struct VectorRange {
+        uint8_t begin, end;
+    };
+
+    constexpr VectorRange PriorityRange(InterruptPriority priority) {
+        switch (priority) {
+            case InterruptPriority::kLow:       return {0x30, 0x60};
+            case InterruptPriority::kNormal:    return {0x60, 0xa0};
+            case InterruptPriority::kHigh:      return {0xa0, InterruptVector::kDynamicEnd};
+        }
+        return {0, 0};
+    }
+
+    /*  각 비트가 벡터 하나에 대응하며, 1이면 사용중인 벡터이다.  */
+    std::array<uint64_t, IDT_SIZE / 64> vector_bitmap{};
+
+    bool IsAllocated(uint8_t vector) {
+        return (vector_bitmap[vector / 64] >> (vector % 64)) & 1u;
+    }
+
+    void SetAllocated(uint8_t vector, bool allocated) {
+        if (allocated) {
+            vector_bitmap[vector / 64] |= (1ul << (vector % 64));
+        } else {
+            vector_bitmap[vector / 64] &= ~(1ul << (vector % 64));
+        }
+    }
+
+    bool IsDynamicVector(uint8_t vector) {
+        return InterruptVector::kDynamicBegin <= vector 
+            && vector < InterruptVector::kDynamicEnd;
+    }
+
+    Error ConfigureMSIVector(const pci::Device& dev, uint8_t vector, uint8_t apic_id) {
+        return pci::ConfigureMSIFixedDestination(
+            dev, apic_id,
+            pci::MSITriggerMode::kLevel,
+            pci::MSIDeliveryMode::kFixed,
+            vector, 0
+        );
+    }
+
+    /*  IOAPIC은 인덱스 레지스터(IOREGSEL)에 번호를 쓰고 데이터 레지스터(IOWIN)로 읽고 쓴다.  */
+    const uintptr_t kIOAPICBase = 0xfec00000;
+
+    uint32_t ReadIOAPIC(uint8_t index) {
+        *reinterpret_cast<volatile uint32_t*>(kIOAPICBase) = index;
+        return *reinterpret_cast<volatile uint32_t*>(kIOAPICBase + 0x10);
+    }
+
+    void WriteIOAPIC(uint8_t index, uint32_t value) {
+        *reinterpret_cast<volatile uint32_t*>(kIOAPICBase) = index;
+        *reinterpret_cast<volatile uint32_t*>(kIOAPICBase + 0x10) = value;
+    }
+
+    const uint32_t kIOAPICMasked = 1u << 16;
+
+    Error ConfigureIOAPICVector(uint8_t irq, uint8_t vector, uint8_t apic_id, bool masked) {
+        const uint32_t max_entry = (ReadIOAPIC(0x01) >> 16) & 0xff;            // 1)
+        if (irq > max_entry) {
+            return MAKE_ERROR(Error::kIndexOutOfRange);
+        }
+
+        const uint8_t index = 0x10 + 2 * irq;
+        WriteIOAPIC(index, kIOAPICMasked);                                      // 2)
+        WriteIOAPIC(index + 1, static_cast<uint32_t>(apic_id) << 24);
+        WriteIOAPIC(index, vector | (masked ? kIOAPICMasked : 0));              // 3)
+        return MAKE_ERROR(Error::kSuccess);
+    }
+
+    /**
+     * IOAPIC의 리다이렉션 엔트리 하나를 설정하는 함수이다.
+     * 
+     * 동작방식:
+     *  1) 버전 레지스터에서 엔트리의 수를 읽어 irq가 범위 안에 있는지 확인한다.
+     * 
+     *  2) 엔트리를 바꾸는 도중에 인터럽트가 전달되지 않도록 먼저 마스크하고 목적지(상위 32비트)를 쓴다.
+     * 
+     *  3) 하위 32비트에 벡터를 쓴다. 나머지 비트가 0이므로 fixed delivery, physical destination,
+     *     active high, edge trigger로 설정된다. ISA 디바이스의 기본 설정과 같다.
+    */
+}
+
+uint8_t GetLocalAPICID() {
+    return *reinterpret_cast<const volatile uint32_t*>(0xfee00020) >> 24;
+}
+
+
+ValueWithError<uint8_t> AllocateInterruptVector(InterruptPriority priority) {
+    const auto range = PriorityRange(priority);
+
+    for (int vector = range.begin; vector < range.end; ++vector) {      // 1)
+        if (!IsAllocated(vector)) {
+            SetAllocated(vector, true);                                 // 2)
+            return {static_cast<uint8_t>(vector), MAKE_ERROR(Error::kSuccess)};
+        }
+    }
+    return {0, MAKE_ERROR(Error::kNoFreeInterruptVector)};              // 3)
+}
+
+/**
+ * 지정한 우선 순위 클래스의 범위에서 비어있는 벡터를 찾아 할당하는 함수이다.
+ * 
+ * 동작방식:
+ *  1) 우선 순위 클래스에 해당하는 벡터 범위를 낮은 번호부터 탐색한다.
+ * 
+ *  2) 사용중이지 않은 벡터를 찾으면 비트맵에 사용중으로 표시하고 반환한다.
+ * 
+ *  3) 범위 안의 모든 벡터가 사용중이라면 kNoFreeInterruptVector를 반환한다.
+ * 
+*/
+
+
+Error FreeInterruptVector(uint8_t vector) {
+    if (!IsDynamicVector(vector) || !IsAllocated(vector)) {
+        return MAKE_ERROR(Error::kIndexOutOfRange);
+    }
+
+    SetAllocated(vector, false);
+    interrupt_vectors[vector] = InterruptVectorEntry{};
+    return MAKE_ERROR(Error::kSuccess);
+}
+
+
+ValueWithError<uint8_t> RegisterInterruptHandler(
+    InterruptHandler handler,
+    InterruptPriority priority,
+    uint8_t apic_id
+) {
+    auto [vector, err] = AllocateInterruptVector(priority);
+    if (err) {
+        return {0, err};
+    }
+
+    interrupt_vectors[vector] = InterruptVectorEntry{
+        handler, priority, apic_id, false, {}, false, 0, interrupt_stats[vector].count
+    };
+
+    SetIDTEntry(
+        idt[vector], MakeIDTAttr(DescriptorType::kInterruptGate, 0),
+        reinterpret_cast<uint64_t>(handler), GetCS()
+    );
+    return {vector, MAKE_ERROR(Error::kSuccess)};
+}
+
+
+ValueWithError<uint8_t> RegisterMSIHandler(
+    const pci::Device& dev,
+    InterruptHandler handler,
+    InterruptPriority priority,
+    uint8_t apic_id
+) {
+    auto [vector, err] = RegisterInterruptHandler(handler, priority, apic_id);
+    if (err) {
+        return {0, err};
+    }
+
+    if (auto err = ConfigureMSIVector(dev, vector, apic_id)) {
+        UnregisterInterruptHandler(vector);
+        return {0, err};
+    }
+
+    interrupt_vectors[vector].has_msi_device = true;
+    interrupt_vectors[vector].msi_device = dev;
+    return {vector, MAKE_ERROR(Error::kSuccess)};
+}
+
+
+ValueWithError<uint8_t> RegisterISAHandler(
+    uint8_t irq,
+    InterruptHandler handler,
+    InterruptPriority priority,
+    uint8_t apic_id
+) {
+    auto [vector, err] = RegisterInterruptHandler(handler, priority, apic_id);
+    if (err) {
+        return {0, err};
+    }
+
+    if (auto err = ConfigureIOAPICVector(irq, vector, apic_id, false)) {
+        UnregisterInterruptHandler(vector);
+        return {0, err};
+    }
+
+    interrupt_vectors[vector].has_isa_irq = true;
+    interrupt_vectors[vector].isa_irq = irq;
+    return {vector, MAKE_ERROR(Error::kSuccess)};
+}
+
+
+Error UnregisterInterruptHandler(uint8_t vector) {
+    if (!IsDynamicVector(vector) || !IsAllocated(vector)) {
+        return MAKE_ERROR(Error::kIndexOutOfRange);
+    }
+
+    const auto& entry = interrupt_vectors[vector];
+    if (entry.has_isa_irq) {
+        ConfigureIOAPICVector(entry.isa_irq, vector, entry.apic_id, true);
+    }
+
+    idt[vector] = InterruptDescriptor{};
+    return FreeInterruptVector(vector);
+}
+
+
+Error SetInterruptAffinity(uint8_t vector, uint8_t apic_id) {
+    if (!IsDynamicVector(vector) || !IsAllocated(vector)) {
+        return MAKE_ERROR(Error::kIndexOutOfRange);
+    }
+
+    auto& entry = interrupt_vectors[vector];
+    if (entry.apic_id == apic_id) {
+        return MAKE_ERROR(Error::kSuccess);
+    }
+
+    if (entry.has_msi_device) {
+        if (auto err = ConfigureMSIVector(entry.msi_device, vector, apic_id)) {
+            return err;
+        }
+    }
+
+    if (entry.has_isa_irq) {
+        if (auto err = ConfigureIOAPICVector(entry.isa_irq, vector, apic_id, false)) {
+            return err;
+        }
+    }
+
+    entry.apic_id = apic_id;
+    return MAKE_ERROR(Error::kSuccess);
+}
+
+
+Error RebalanceInterrupts(const uint8_t* apic_ids, size_t num_cpus) {
+    if (num_cpus == 0) {
+        return MAKE_ERROR(Error::kSuccess);
+    }
+
+    std::array<uint8_t, IDT_SIZE> order;                                // 1)
+    size_t num_vectors = 0;
+    for (int vector = InterruptVector::kDynamicBegin; 
+            vector < InterruptVector::kDynamicEnd; ++vector) {
+        if (IsAllocated(vector)) {
+            order[num_vectors++] = vector;
+        }
+    }
+
+    std::array<uint64_t, IDT_SIZE> load{};                              // 2)
+    for (size_t i = 0; i < num_vectors; ++i) {
+        const auto vector = order[i];
+        const uint64_t count = interrupt_stats[vector].count;
+        const uint64_t base = interrupt_vectors[vector].balanced_count;
+        load[vector] = count >= base ? count - base : count;
+    }
+
+    std::sort(order.begin(), order.begin() + num_vectors,
+        [&load](uint8_t lhs, uint8_t rhs) {
+            return load[lhs] > load[rhs];
+        });
+
+    std::array<uint64_t, IDT_SIZE> cpu_load{};
+    Error result = MAKE_ERROR(Error::kSuccess);
+    for (size_t i = 0; i < num_vectors; ++i) {
+        const auto vector = order[i];
+
+        size_t target = 0;                                              // 3)
+        for (size_t cpu = 1; cpu < num_cpus && cpu < cpu_load.size(); ++cpu) {
+            if (cpu_load[cpu] < cpu_load[target]) {
+                target = cpu;
+            }
+        }
+
+        cpu_load[target] += load[vector];
+        if (auto err = SetInterruptAffinity(vector, apic_ids[target])) {  // 4)
+            Log(kWarn, "failed to move vector %02x to CPU %u: %s at %s:%d\n",
+                    vector, apic_ids[target], err.Name(), err.File(), err.Line());
+            if (!result) {
+                result = err;
+            }
+        }
+        interrupt_vectors[vector].balanced_count = interrupt_stats[vector].count;  // 5)
+    }
+    return result;
+}
+
+/**
+ * 벡터별 인터럽트 발생 횟수를 이용하여 인터럽트를 여러 CPU에 분배하는 함수이다.
+ * 
+ * 동작방식:
+ *  1) 할당된 동적 벡터의 목록을 만든다.
+ * 
+ *  2) 지난 구간 동안의 발생 횟수(interrupt_stats의 횟수에서 balanced_count를 뺀 값)가
+ *     많은 벡터가 앞에 오도록 정렬한다. ResetInterruptStats()로 횟수가 줄었다면 현재 횟수를 그대로 쓴다.
+ * 
+ *  3) 지금까지 배정된 부하의 합이 가장 작은 CPU를 선택한다.
+ * 
+ *  4) 선택한 CPU로 벡터의 affinity를 변경한다. MSI 벡터라면 디바이스의 메세지 주소도 변경된다.
+ *     변경에 실패한 벡터는 이전 CPU에 남으며, 실패를 로그로 남기고 나머지 벡터를 계속 배정한다.
+ *     처음으로 실패한 에러를 반환한다.
+ * 
+ *  5) 다음 구간의 비율을 측정하기 위해 현재 발생 횟수를 balanced_count에 기록한다.
+ * 
+*/
+
+
+
+/**
+ * ======== 인터럽트 통계 ========
+*/
+
+std::array<InterruptStats, IDT_SIZE> interrupt_stats{};
+
+namespace {
+    void UpdateMinMax(uint64_t& min, uint64_t& max, uint64_t value) {
+        if (value < min) {
+            min = value;
+        }
+        if (value > max) {
+            max = value;
+        }
+    }
+
+    uint64_t Average(uint64_t total, uint64_t n) {
+        return n == 0 ? 0 : total / n;
+    }
+
+    uint64_t MinOrZero(uint64_t min) {
+        return min == UINT64_MAX ? 0 : min;
+    }
+}
+
+void RecordISRCycles(uint8_t vector, uint64_t cycles) {
+    auto& stats = interrupt_stats[vector];
+
+    stats.isr_cycles_total += cycles;
+    UpdateMinMax(stats.isr_cycles_min, stats.isr_cycles_max, cycles);
+}
+
+void RecordQueueLatency(uint8_t vector, uint64_t isr_entry_tsc) {
+    auto& stats = interrupt_stats[vector];
+    const uint64_t cycles = ReadTSC() - isr_entry_tsc;
+
+    ++stats.queued;
+    stats.queue_cycles_total += cycles;
+    UpdateMinMax(stats.queue_cycles_min, stats.queue_cycles_max, cycles);
+}
+
+const InterruptStats& GetInterruptStats(uint8_t vector) {
+    return interrupt_stats[vector];
+}
+
+void ResetInterruptStats() {
+    const auto rflags = SaveAndDisableInterrupts();
+    interrupt_stats.fill(InterruptStats{});
+    RestoreInterrupts(rflags);
+}
+
+void DumpInterruptStats() {
+    printk("vec     count  isr min/avg/max       queue min/avg/max\n");
+
+    for (int vector = 0; vector < IDT_SIZE; ++vector) {
+        const auto rflags = SaveAndDisableInterrupts();                 // 1)
+        const InterruptStats stats = interrupt_stats[vector];
+        RestoreInterrupts(rflags);
+
+        if (stats.count == 0) {                                         // 2)
+            continue;
+        }
+
+        printk("%02x %9" PRIu64 "  %" PRIu64 "/%" PRIu64 "/%" PRIu64    // 3)
+               "  %" PRIu64 "/%" PRIu64 "/%" PRIu64 "\n",
+            vector, stats.count,
+            MinOrZero(stats.isr_cycles_min),
+            Average(stats.isr_cycles_total, stats.count),
+            stats.isr_cycles_max,
+            MinOrZero(stats.queue_cycles_min),
+            Average(stats.queue_cycles_total, stats.queued),
+            stats.queue_cycles_max);
+    }
+}
+
+/**
+ * 벡터별 인터럽트 통계를 터미널에 출력하는 함수이다.
+ * 
+ * 동작방식:
+ *  1) ISR이 통계를 갱신하는 도중에 읽지 않도록 인터럽트를 막은 상태로 복사한다.
+ * 
+ *  2) 한 번도 발생하지 않은 벡터는 출력하지 않는다.
+ * 
+ *  3) 발생 횟수, ISR 실행 사이클, 대기 사이클의 최소 / 평균 / 최대값을 한 줄로 출력한다.
+ *     단위는 모두 TSC 사이클이며, 기록이 없는 최소값은 0으로 출력한다.
+ * 
+*/
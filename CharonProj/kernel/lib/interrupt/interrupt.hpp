@@ -7,8 +7,12 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include "../memory/x86_descriptor.hpp"
+#include "../error/error.hpp"
+#include "../pci/pci.hpp"
+#include "interrupt_asm.h"
 #define IDT_SIZE 256
 
 union InterruptDescriptorAttribute {
@@ -131,7 +135,8 @@ void SetIDTEntry (
 class InterruptVector {
     public:
         enum Number {
-            kXHCI = 0x40,
+            kDynamicBegin   = 0x30,
+            kDynamicEnd     = 0xf0,
         };
 };
 
@@ -146,8 +151,9 @@ class InterruptVector {
  * 개발자의 마음대로 설정할 수 있는 것도 있다.
  * 예를 들어 0으로 나누는 것에 관한 인터럽트는 0번으로 고정되어 있다.
  * 
- * 이 코드에서 XHCI의 경우 USB과 관련된 인터럽트로, 개발자
- * 마음대로 설정할 수 있다.
+ * 0x00 ~ 0x1f는 CPU 예외에 예약되어 있으므로, 드라이버에 나누어 줄 수 있는 
+ * 벡터는 [kDynamicBegin, kDynamicEnd) 범위로 제한한다. 
+ * 이 범위의 벡터는 더 이상 소스에 고정하지 않고 AllocateInterruptVector()로 할당받는다.
  * 
 */
 
@@ -185,3 +191,211 @@ void NotifyEndOfInterrupt();
  * @brief 인터럽트가 종료되었음을 알리는 메모리를 특정 주소에 작성하는 함수
  * 
 */
+
+
+
+/**
+ * ======== 인터럽트 벡터 할당자 ========
+*/
+
+enum class InterruptPriority {
+    kLow,                                   // 0x30 ~ 0x5f
+    kNormal,                                // 0x60 ~ 0x9f
+    kHigh,                                  // 0xa0 ~ 0xef
+};
+
+/**
+ * @brief 인터럽트의 우선 순위 클래스를 정의한다.
+ * 
+ * Local APIC는 벡터 번호의 상위 4비트(vector >> 4)를 우선 순위 클래스로 사용한다.
+ * 따라서 높은 번호의 벡터를 받은 인터럽트일수록 먼저 처리되며, 
+ * 드라이버는 벡터 번호 대신 우선 순위 클래스만 지정하면 된다.
+ * 
+*/
+
+
+using InterruptHandler = void (*)(InterruptFrame* frame);
+
+struct InterruptVectorEntry {
+    InterruptHandler handler;               // IDT에 등록된 인터럽트 핸들러
+    InterruptPriority priority;             // 벡터를 할당받은 우선 순위 클래스
+    uint8_t apic_id;                        // 인터럽트를 받을 CPU의 Local APIC ID
+    bool has_msi_device;                    // MSI로 연결된 PCI 디바이스가 있는지의 여부
+    pci::Device msi_device;                 // MSI 메세지를 다시 설정할 때 사용하는 PCI 디바이스
+    bool has_isa_irq;                       // IOAPIC을 거쳐 연결된 ISA IRQ가 있는지의 여부
+    uint8_t isa_irq;                        // IOAPIC 리다이렉션 엔트리를 다시 설정할 때 사용하는 IRQ 번호
+    uint64_t balanced_count;                // 마지막으로 분배했을 때의 interrupt_stats[vector].count
+};
+
+/**
+ * @brief 할당된 인터럽트 벡터 하나의 정보를 저장한다.
+ * 
+ * 발생 횟수는 interrupt_stats에만 센다. RebalanceInterrupts()는 그 횟수가 
+ * balanced_count 이후로 늘어난 만큼을 CPU 간에 인터럽트를 분배할 때 부하의 기준으로 사용한다.
+*/
+
+extern std::array<InterruptVectorEntry, IDT_SIZE> interrupt_vectors;
+
+
+uint8_t GetLocalAPICID();
+/**
+ * @brief 현재 CPU의 Local APIC ID를 반환한다.
+*/
+
+ValueWithError<uint8_t> AllocateInterruptVector(InterruptPriority priority);
+Error FreeInterruptVector(uint8_t vector);
+/**
+ * @brief 지정한 우선 순위 클래스에서 비어있는 벡터를 할당하거나 반납한다.
+ * 
+ * 비어있는 벡터가 없다면 kNoFreeInterruptVector를 반환한다.
+*/
+
+ValueWithError<uint8_t> RegisterInterruptHandler(
+    InterruptHandler handler,
+    InterruptPriority priority,
+    uint8_t apic_id
+);
+
+ValueWithError<uint8_t> RegisterMSIHandler(
+    const pci::Device& dev,
+    InterruptHandler handler,
+    InterruptPriority priority,
+    uint8_t apic_id
+);
+
+ValueWithError<uint8_t> RegisterISAHandler(
+    uint8_t irq,
+    InterruptHandler handler,
+    InterruptPriority priority,
+    uint8_t apic_id
+);
+
+Error UnregisterInterruptHandler(uint8_t vector);
+/**
+ * @brief 인터럽트 핸들러를 등록하거나 해제한다.
+ * 
+ * RegisterInterruptHandler():
+ *  벡터를 할당받아 IDT에 핸들러를 기록하고, 할당된 벡터 번호를 반환한다.
+ * 
+ * RegisterMSIHandler():
+ *  위의 과정에 더해 dev의 MSI/MSI-X 메세지가 할당된 벡터와 apic_id를 
+ *  향하도록 설정한다. 드라이버는 더 이상 벡터 번호를 직접 다루지 않는다.
+ *  MSI를 켜는 즉시 디바이스가 인터럽트를 보낼 수 있으므로, LoadIDT()로 IDT를 읽어들인 뒤에 호출한다.
+ * 
+ * RegisterISAHandler():
+ *  COM1(IRQ4)처럼 PCI가 아닌 ISA 디바이스의 IRQ를 IOAPIC의 리다이렉션 엔트리로
+ *  할당된 벡터와 apic_id에 연결한다. (edge trigger, active high)
+ *  IOAPIC은 기본 주소(0xfec00000)에 있고 ISA IRQ 번호가 GSI 번호와 같다고 가정한다.
+ *  ACPI MADT를 해석하지 않으므로 interrupt source override는 반영하지 않는다.
+ * 
+ * UnregisterInterruptHandler():
+ *  IDT 엔트리를 비활성화하고 벡터를 반납한다. ISA IRQ라면 IOAPIC 엔트리도 마스크한다.
+*/
+
+Error SetInterruptAffinity(uint8_t vector, uint8_t apic_id);
+/**
+ * @brief vector의 인터럽트를 받을 CPU를 변경한다.
+ * 
+ * MSI로 연결된 벡터라면 디바이스의 MSI 메세지 주소를, ISA IRQ라면 IOAPIC 엔트리의 목적지를 다시 설정한다.
+*/
+
+Error RebalanceInterrupts(const uint8_t* apic_ids, size_t num_cpus);
+/**
+ * @brief 벡터별 인터럽트 횟수를 기준으로 인터럽트를 CPU에 분배한다.
+ * 
+ * 발생 횟수가 많은 벡터부터 누적 부하가 가장 적은 CPU에 배정하며,
+ * 배정이 끝나면 각 벡터의 현재 횟수를 balanced_count에 기록하여 다음 구간의 비율을 측정한다.
+ * affinity를 바꾸지 못한 벡터가 있다면 로그를 남기고, 처음으로 발생한 에러를 반환한다.
+*/
+
+/**
+ * ======== 인터럽트 통계 ========
+*/
+
+struct InterruptStats {
+    uint64_t count;                         // ISR이 실행된 횟수. CountInterrupt()가 증가시킨다.
+
+    uint64_t isr_cycles_min = UINT64_MAX;   // ISR 진입부터 종료까지 걸린 TSC 사이클
+    uint64_t isr_cycles_max;
+    uint64_t isr_cycles_total;
+
+    uint64_t queued;                        // main_queue에서 처리된 메세지 수
+    uint64_t queue_cycles_min = UINT64_MAX; // ISR 진입부터 main_queue의 소비자가 메세지를 꺼낼 때까지의 TSC 사이클
+    uint64_t queue_cycles_max;
+    uint64_t queue_cycles_total;
+};
+
+/**
+ * @brief 벡터 하나에 대한 누적 통계를 저장한다.
+ * 
+ * 평균값은 *_total을 횟수로 나누어 구한다. *_min은 기록이 없으면 UINT64_MAX이다.
+ * xHCI의 interrupt moderation 값을 조정할 때 이 통계를 기준으로 삼는다.
+*/
+
+extern std::array<InterruptStats, IDT_SIZE> interrupt_stats;
+
+
+inline void CountInterrupt(uint8_t vector) {
+    ++interrupt_stats[vector].count;
+}
+/**
+ * @brief 인터럽트 핸들러의 맨 앞에서 호출하여 벡터의 발생 횟수를 기록한다.
+ * 
+ * 이 횟수는 DumpInterruptStats()와 RebalanceInterrupts()가 함께 사용한다.
+*/
+
+
+void RecordISRCycles(uint8_t vector, uint64_t cycles);
+void RecordQueueLatency(uint8_t vector, uint64_t isr_entry_tsc);
+/**
+ * @brief ISR의 실행 시간 / 메세지 대기 시간을 통계에 기록한다.
+ * 
+ * RecordQueueLatency()는 main_queue에서 메세지를 꺼낸 직후에 호출하며,
+ * 메세지에 담긴 ISR 진입 시각과 현재 시각의 차이를 기록한다.
+*/
+
+const InterruptStats& GetInterruptStats(uint8_t vector);
+void ResetInterruptStats();
+void DumpInterruptStats();
+/**
+ * @brief 인터럽트 통계를 조회 / 초기화 / 터미널에 출력한다.
+ * 
+ * DumpInterruptStats()는 한 번 이상 발생한 벡터만 출력한다.
+*/
+
+
+class InterruptStatsScope {
+    public:
+        explicit InterruptStatsScope(uint8_t vector) 
+            : vector_{vector}, start_{ReadTSC()} {
+            CountInterrupt(vector_);
+        }
+
+        ~InterruptStatsScope() {
+            RecordISRCycles(vector_, ReadTSC() - start_);
+        }
+
+        InterruptStatsScope(const InterruptStatsScope&) = delete;
+        InterruptStatsScope& operator=(const InterruptStatsScope&) = delete;
+
+        uint64_t Start() const {  return start_;  }
+
+    private:
+        uint8_t vector_;
+        uint64_t start_;
+};
+
+/**
+ * @brief 인터럽트 핸들러의 맨 앞에 선언하여 ISR의 실행 시간을 측정하는 클래스
+ * 
+ * 생성 시 TSC를 읽고 발생 횟수를 증가시키며, 핸들러가 끝나 소멸될 때 
+ * 걸린 사이클을 기록한다. Start()는 main_queue에 넣을 메세지의 시각으로 사용한다.
+ * 
+ * EX)
+ *  __attribute__((interrupt))
+ *  void IntHandler(InterruptFrame* frame) {
+ *      InterruptStatsScope stats{vector};
+ *      main_queue->Push(Message{type, vector, stats.Start()});
+ *      NotifyEndOfInterrupt();
+ *  }
+*/
@@ -23,3 +23,10 @@ LoadIDT:
     mov rsp, rbp
     pop rbp
     ret
+
+global ReadTSC              ; uint64_t ReadTSC(void)
+ReadTSC:
+    rdtsc                   ; EDX:EAX <- time stamp counter
+    shl rdx, 32
+    or rax, rdx
+    ret
@@ -5,4 +5,5 @@
 extern "C" {
     uint16_t GetCS(void);
     void LoadIDT(uint16_t limit, uint64_t offset);
+    uint64_t ReadTSC(void);
 }
\ No newline at end of file
@@ -21,4 +21,18 @@ global ReadIo32     ; uint32_t ReadIo32(uint16_t addr)
 ReadIo32:
     mov dx, di      ; 앞의 기능과 알치
     in eax, dx      ; DX레지스터에 저장된 IO포트에서 32비트 정수를 EAX레지스터에 복사 
-    ret
\ No newline at end of file
+    ret
+
+global WriteIo8     ; void WriteIo8(uint16_t addr, uint8_t data)
+WriteIo8:
+    mov dx, di      ; RDI레지스터에 저장된 16비트 주소를 DX레지스터로 복사
+    mov al, sil     ; RSI레지스터에 저장된 8비트 데이터를 AL레지스터로 복사
+    out dx, al      ; DX레지스터에 지정된 I/O포트로 AL레지스터의 8비트 데이터를 출력 (UART 등 8비트 레지스터용)
+    ret
+
+
+global ReadIo8      ; uint8_t ReadIo8(uint16_t addr)
+ReadIo8:
+    mov dx, di      ; 앞의 기능과 일치
+    in al, dx       ; DX레지스터에 지정된 I/O포트에서 8비트 정수를 AL레지스터에 복사
+    ret
@@ -5,4 +5,6 @@
 extern "C" {
     void WriteIo32(uint16_t addr, uint32_t data);
     uint32_t ReadIo32(uint16_t addr);
+    void WriteIo8(uint16_t addr, uint8_t data);
+    uint8_t ReadIo8(uint16_t addr);
 }
\ No newline at end of file
@@ -0,0 +1,521 @@
+/**
+ * @file format.cpp
+*/
+
+#include "format.hpp"
+
+
+void BufferSink::Write(const char* s, size_t length) {
+    if (size_ == 0) {
+        return;
+    }
+    for (size_t i = 0; i < length && pos_ + 1 < size_; ++i) {
+        buf_[pos_++] = s[i];
+    }
+}
+
+void BufferSink::Terminate() {
+    if (size_ > 0) {
+        buf_[pos_] = '\0';
+    }
+}
+
+
+
+namespace {
+    /**
+     * ======== 인자 공급자 ========
+    */
+
+    enum Length {
+        kChar,                                              // hh
+        kShort,                                             // h
+        kInt,                                               // (없음)
+        kLong,                                              // l, ll, z, j, t
+    };
+
+    class VaListArgs {
+        public:
+            explicit VaListArgs(va_list ap) {  va_copy(ap_, ap);  }
+            ~VaListArgs() {  va_end(ap_);  }
+
+            int64_t Signed(Length length) {
+                return length == kLong ? va_arg(ap_, long) : va_arg(ap_, int);
+            }
+            uint64_t Unsigned(Length length) {
+                return length == kLong ? va_arg(ap_, unsigned long) : va_arg(ap_, unsigned int);
+            }
+            const void* Pointer() {  return va_arg(ap_, const void*);  }
+
+        private:
+            va_list ap_;
+    };
+
+    class ArrayArgs {
+        public:
+            ArrayArgs(const uint64_t* args, int num_args) : args_{args}, num_args_{num_args} {}
+
+            int64_t Signed(Length length) {
+                const uint64_t v = Next();
+                return length == kLong ? static_cast<int64_t>(v) : static_cast<int32_t>(v);
+            }
+            uint64_t Unsigned(Length length) {
+                const uint64_t v = Next();
+                return length == kLong ? v : static_cast<uint32_t>(v);
+            }
+            const void* Pointer() {  return reinterpret_cast<const void*>(Next());  }
+
+        private:
+            const uint64_t* args_;
+            int num_args_;
+            int index_{0};
+
+            uint64_t Next() {  return index_ < num_args_ ? args_[index_++] : 0;  }
+    };
+
+    class RecordingArgs {
+        public:
+            RecordingArgs(VaListArgs& source, uint64_t* args, int max_args)
+                : source_{source}, args_{args}, max_args_{max_args} {}
+
+            int64_t Signed(Length length) {  return Record(source_.Signed(length));  }
+            uint64_t Unsigned(Length length) {  return Record(source_.Unsigned(length));  }
+            const void* Pointer() {
+                return reinterpret_cast<const void*>(Record(reinterpret_cast<uintptr_t>(source_.Pointer())));
+            }
+
+            bool Full() const {  return num_args_ == max_args_;  }
+            int Count() const {  return num_args_;  }
+
+        private:
+            VaListArgs& source_;
+            uint64_t* args_;
+            int max_args_;
+            int num_args_{0};
+
+            uint64_t Record(uint64_t v) {
+                if (num_args_ < max_args_) {
+                    args_[num_args_++] = v;
+                }
+                return v;
+            }
+    };
+
+    /*
+     * 변환기는 인자를 어디서 읽는지 알 필요가 없도록 인자 공급자를 템플릿 인자로 받는다.
+     * VaListArgs는 가변 인자에서, ArrayArgs는 Log()가 저장한 64비트 인자 배열에서 읽는다.
+     * 배열에 저장된 int 인자는 하위 32비트만 의미가 있으므로 길이 수식어에 맞추어 잘라낸다.
+     *
+     * RecordingArgs는 가변 인자를 길이 수식어에 맞는 형식(int, long, 포인터)으로 읽어 
+     * 64비트로 넓힌 뒤 배열에 저장한다. Log()가 링에 저장할 인자를 모을 때 사용한다.
+     *
+     */
+
+
+
+    /**
+     * ======== 출력 보조 함수 ========
+    */
+
+    class Counter {
+        public:
+            explicit Counter(OutputSink& sink) : sink_{sink} {}
+
+            void Put(const char* s, size_t length) {
+                if (length > 0) {
+                    sink_.Write(s, length);
+                    count_ += length;
+                }
+            }
+
+            void Pad(char c, int n) {
+                static const char kSpaces[] = "                ";
+                static const char kZeros[] = "0000000000000000";
+                const char* chunk = c == '0' ? kZeros : kSpaces;
+                while (n > 0) {
+                    const int m = n < 16 ? n : 16;
+                    Put(chunk, m);
+                    n -= m;
+                }
+            }
+
+            int Count() const {  return static_cast<int>(count_);  }
+
+        private:
+            OutputSink& sink_;
+            size_t count_{0};
+    };
+
+    struct Spec {
+        bool left{false}, zero{false}, plus{false}, space{false}, alt{false};
+        int width{0};
+        int precision{-1};                                  // -1이면 정밀도가 없다.
+        Length length{kInt};
+    };
+
+    char* ToDigits(uint64_t value, unsigned base, bool upper, char* end) {
+        const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+        char* p = end;
+        do {
+            *--p = digits[value % base];
+            value /= base;
+        } while (value);
+        return p;
+    }
+
+    void PutNumber(Counter& out, const Spec& spec, uint64_t magnitude, bool negative,
+                   unsigned base, bool upper) {
+        char buf[24];
+        char* end = buf + sizeof(buf);
+        char* start = ToDigits(magnitude, base, upper, end);
+        int num_digits = static_cast<int>(end - start);
+        if (spec.precision == 0 && magnitude == 0) {                        // 1)
+            num_digits = 0;
+        }
+
+        char prefix[2];                                                     // 2)
+        int prefix_len = 0;
+        if (negative) {
+            prefix[prefix_len++] = '-';
+        } else if (spec.plus) {
+            prefix[prefix_len++] = '+';
+        } else if (spec.space) {
+            prefix[prefix_len++] = ' ';
+        }
+        if (spec.alt && base == 16 && magnitude != 0) {
+            prefix[prefix_len++] = '0';
+            prefix[prefix_len++] = upper ? 'X' : 'x';
+        }
+
+        int zeros = spec.precision > num_digits ? spec.precision - num_digits : 0;     // 3)
+        if (spec.alt && base == 8 && zeros == 0 && (num_digits == 0 || *start != '0')) {
+            zeros = 1;
+        }
+        int body = prefix_len + zeros + num_digits;
+        if (spec.zero && !spec.left && spec.precision < 0 && spec.width > body) {
+            zeros += spec.width - body;
+            body = spec.width;
+        }
+
+        const int pad = spec.width > body ? spec.width - body : 0;          // 4)
+        if (!spec.left) {
+            out.Pad(' ', pad);
+        }
+        out.Put(prefix, prefix_len);
+        out.Pad('0', zeros);
+        out.Put(end - num_digits, num_digits);
+        if (spec.left) {
+            out.Pad(' ', pad);
+        }
+    }
+
+    /**
+     * 정수 하나를 spec에 맞추어 출력하는 함수이다.
+     *
+     * 동작방식:
+     *  1) 정밀도가 0이고 값이 0이면 숫자를 출력하지 않는다. (C 표준과 같다)
+     *
+     *  2) 부호와 "0x" 접두사를 정한다.
+     *
+     *  3) 정밀도만큼 앞에 0을 채운다. '0' 플래그가 있고 정밀도가 없다면 폭까지 0으로 채운다.
+     *     '#'을 붙인 8진수는 맨 앞 글자가 0이 되도록 한다.
+     *
+     *  4) 남은 폭을 공백으로 채운다. '-' 플래그가 있다면 오른쪽에 채운다.
+    */
+
+    void PutString(Counter& out, const Spec& spec, const char* s) {
+        if (s == nullptr) {
+            s = "(null)";
+        }
+        size_t length = 0;
+        while (s[length] && (spec.precision < 0 || length < static_cast<size_t>(spec.precision))) {
+            ++length;
+        }
+
+        const int pad = spec.width > static_cast<int>(length) ? spec.width - static_cast<int>(length) : 0;
+        if (!spec.left) {
+            out.Pad(' ', pad);
+        }
+        out.Put(s, length);
+        if (spec.left) {
+            out.Pad(' ', pad);
+        }
+    }
+
+
+
+    template <typename Args>
+    const char* ParseSpec(const char* p, Args& args, Spec& spec) {
+        for (;; ++p) {
+            if (*p == '-') {  spec.left = true;  }
+            else if (*p == '0') {  spec.zero = true;  }
+            else if (*p == '+') {  spec.plus = true;  }
+            else if (*p == ' ') {  spec.space = true;  }
+            else if (*p == '#') {  spec.alt = true;  }
+            else {  break;  }
+        }
+
+        if (*p == '*') {
+            spec.width = static_cast<int>(args.Signed(kInt));
+            if (spec.width < 0) {
+                spec.left = true;
+                spec.width = -spec.width;
+            }
+            ++p;
+        } else {
+            while (*p >= '0' && *p <= '9') {
+                spec.width = spec.width * 10 + (*p++ - '0');
+            }
+        }
+        if (*p == '.') {
+            ++p;
+            spec.precision = 0;
+            if (*p == '*') {
+                spec.precision = static_cast<int>(args.Signed(kInt));
+                ++p;
+            } else {
+                while (*p >= '0' && *p <= '9') {
+                    spec.precision = spec.precision * 10 + (*p++ - '0');
+                }
+            }
+        }
+
+        if (*p == 'h') {
+            ++p;
+            spec.length = kShort;
+            if (*p == 'h') {
+                ++p;
+                spec.length = kChar;
+            }
+        } else {
+            while (*p == 'l' || *p == 'z' || *p == 'j' || *p == 't') {
+                spec.length = kLong;
+                ++p;
+            }
+        }
+        return p;
+    }
+
+    /**
+     * '%' 다음의 플래그, 폭, 정밀도, 길이 수식어를 spec으로 읽고 변환 문자의 위치를 반환하는 함수이다.
+     * 폭과 정밀도가 '*'이면 args에서 int 인자를 하나씩 읽으며, 음수 폭은 '-' 플래그로 처리한다.
+     * l, ll, z, j, t는 x86-64에서 모두 64비트이다.
+     *
+     * 변환기(FormatWith)와 Log()의 인자 수집(CaptureArgs)이 같은 해석을 사용하므로,
+     * 두 곳에서 인자를 읽는 순서와 크기가 항상 같다.
+    */
+
+
+
+    /**
+     * ======== 변환기 ========
+    */
+
+    template <typename Args>
+    int FormatWith(OutputSink& sink, const char* format, Args& args) {
+        Counter out{sink};
+        const char* p = format;
+
+        while (*p) {
+            const char* literal = p;                                        // 1)
+            while (*p && *p != '%') {
+                ++p;
+            }
+            out.Put(literal, p - literal);
+            if (*p == '\0') {
+                break;
+            }
+
+            const char* conv_start = p++;
+            switch (*p) {                                                   // 2)
+                case 'd': {
+                    const int64_t v = args.Signed(kInt);
+                    char buf[24];
+                    char* end = buf + sizeof(buf);
+                    char* start = ToDigits(v < 0 ? -static_cast<uint64_t>(v) : v, 10, false, end);
+                    if (v < 0) {
+                        *--start = '-';
+                    }
+                    out.Put(start, end - start);
+                    ++p;
+                    continue;
+                }
+                case 'x': {
+                    char buf[24];
+                    char* end = buf + sizeof(buf);
+                    char* start = ToDigits(args.Unsigned(kInt), 16, false, end);
+                    out.Put(start, end - start);
+                    ++p;
+                    continue;
+                }
+                case 's': {
+                    const char* s = static_cast<const char*>(args.Pointer());
+                    if (s == nullptr) {
+                        s = "(null)";
+                    }
+                    const char* e = s;
+                    while (*e) {
+                        ++e;
+                    }
+                    out.Put(s, e - s);
+                    ++p;
+                    continue;
+                }
+                case '%':
+                    out.Put("%", 1);
+                    ++p;
+                    continue;
+                default:
+                    break;
+            }
+
+            Spec spec;                                                      // 3)
+            p = ParseSpec(p, args, spec);
+
+            switch (*p) {                                                   // 4)
+                case 'd':
+                case 'i': {
+                    int64_t v = args.Signed(spec.length);
+                    if (spec.length == kShort) {  v = static_cast<int16_t>(v);  }
+                    if (spec.length == kChar) {  v = static_cast<int8_t>(v);  }
+                    PutNumber(out, spec, v < 0 ? -static_cast<uint64_t>(v) : v, v < 0, 10, false);
+                    break;
+                }
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'o': {
+                    uint64_t v = args.Unsigned(spec.length);
+                    if (spec.length == kShort) {  v = static_cast<uint16_t>(v);  }
+                    if (spec.length == kChar) {  v = static_cast<uint8_t>(v);  }
+                    const unsigned base = *p == 'u' ? 10 : (*p == 'o' ? 8 : 16);
+                    PutNumber(out, spec, v, false, base, *p == 'X');
+                    break;
+                }
+                case 'p': {
+                    spec.alt = true;
+                    PutNumber(out, spec, reinterpret_cast<uintptr_t>(args.Pointer()), false, 16, false);
+                    break;
+                }
+                case 'c': {
+                    const char c = static_cast<char>(args.Signed(kInt));
+                    spec.precision = -1;
+                    char s[2] = {c, '\0'};
+                    if (c == '\0') {
+                        out.Put(s, 1);
+                    } else {
+                        PutString(out, spec, s);
+                    }
+                    break;
+                }
+                case 's':
+                    PutString(out, spec, static_cast<const char*>(args.Pointer()));
+                    break;
+                default:                                                    // 5)
+                    if (*p == '\0') {
+                        out.Put(conv_start, p - conv_start);
+                        continue;
+                    }
+                    out.Put(conv_start, p - conv_start + 1);
+                    break;
+            }
+            ++p;
+        }
+
+        return out.Count();
+    }
+
+    /**
+     * 형식 문자열을 한 번 훑으며 변환 결과를 sink로 바로 출력하는 함수이다.
+     *
+     * 동작방식:
+     *  1) 다음 '%'까지의 일반 글자 구간을 한 번의 Write()로 출력한다.
+     *
+     *  2) 빠른 경로: 플래그, 폭, 정밀도가 없는 %d, %x, %s, %%는 spec을 해석하지 않고 바로 변환한다.
+     *     커널의 로그는 대부분 이 네 가지로 이루어져 있다.
+     *
+     *  3) ParseSpec()으로 플래그, 폭, 정밀도, 길이 수식어를 읽는다.
+     *
+     *  4) 변환 문자에 맞추어 인자를 읽고 출력한다. %p는 "%#lx"와 같이 출력한다.
+     *
+     *  5) 지원하지 않는 변환 문자(%f 등)는 인자를 소비하지 않고 문자 그대로 출력한다.
+    */
+}
+
+
+int VFormat(OutputSink& sink, const char* format, va_list ap) {
+    VaListArgs args{ap};
+    return FormatWith(sink, format, args);
+}
+
+int Format(OutputSink& sink, const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    const int result = VFormat(sink, format, ap);
+    va_end(ap);
+    return result;
+}
+
+int FormatArgs(OutputSink& sink, const char* format, const uint64_t* args, int num_args) {
+    ArrayArgs array_args{args, num_args};
+    return FormatWith(sink, format, array_args);
+}
+
+int CaptureArgs(const char* format, va_list ap, uint64_t* args, int max_args) {
+    VaListArgs source{ap};
+    RecordingArgs recorder{source, args, max_args};
+
+    const char* p = format;
+    while (*p && !recorder.Full()) {
+        if (*p++ != '%') {
+            continue;
+        }
+        if (*p == '%') {
+            ++p;
+            continue;
+        }
+
+        Spec spec;
+        p = ParseSpec(p, recorder, spec);
+        switch (*p) {
+            case 'd':
+            case 'i':
+                recorder.Signed(spec.length);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                recorder.Unsigned(spec.length);
+                break;
+            case 'c':
+                recorder.Signed(kInt);
+                break;
+            case 'p':
+            case 's':
+                recorder.Pointer();
+                break;
+            case '\0':
+                return recorder.Count();
+            default:
+                break;
+        }
+        ++p;
+    }
+    return recorder.Count();
+}
+
+int VSNPrintf(char* buf, size_t size, const char* format, va_list ap) {
+    BufferSink sink{buf, size};
+    const int result = VFormat(sink, format, ap);
+    sink.Terminate();
+    return result;
+}
+
+int SNPrintf(char* buf, size_t size, const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    const int result = VSNPrintf(buf, size, format, ap);
+    va_end(ap);
+    return result;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file format.hpp
+ *
+ * 힙을 사용하지 않는 커널 전용 printf 형식 변환기와, 변환 결과를 받는 출력 대상(sink)을 정의한다.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdarg>
+
+
+class OutputSink {
+    public:
+        virtual ~OutputSink() = default;
+        virtual void Write(const char* s, size_t length) = 0;
+};
+
+/**
+ * @brief 형식 변환 결과를 받는 출력 대상
+ *
+ * 변환기는 글자마다가 아니라 조각(형식 문자열의 일반 글자 구간, 변환된 숫자, %s 문자열)마다
+ * Write()를 한 번 호출한다. 터미널, 시리얼 포트, 메모리 버퍼 등이 이 클래스를 구현한다.
+*/
+
+
+
+class BufferSink : public OutputSink {
+    public:
+        BufferSink(char* buf, size_t size) : buf_{buf}, size_{size} {}
+
+        virtual void Write(const char* s, size_t length) override;
+        void Terminate();
+
+    private:
+        char* buf_;
+        size_t size_;
+        size_t pos_{0};
+};
+
+/**
+ * @brief 크기가 정해진 메모리 버퍼에 쓰는 출력 대상
+ *
+ * 버퍼가 가득 차면 나머지는 버린다. Terminate()는 마지막에 '\0'을 붙이며,
+ * 항상 '\0'을 위한 1바이트를 남겨둔다.
+*/
+
+
+
+template <size_t N>
+class ChunkedSink : public OutputSink {
+    public:
+        explicit ChunkedSink(OutputSink& next) : next_{next} {}
+        ~ChunkedSink() {  Flush();  }
+
+        virtual void Write(const char* s, size_t length) override {
+            while (length > 0) {
+                if (pos_ == N) {
+                    Flush();
+                }
+                const size_t n = length < N - pos_ ? length : N - pos_;
+                for (size_t i = 0; i < n; ++i) {
+                    buf_[pos_ + i] = s[i];
+                }
+                pos_ += n;
+                s += n;
+                length -= n;
+            }
+        }
+
+        void Flush() {
+            if (pos_ > 0) {
+                next_.Write(buf_, pos_);
+                pos_ = 0;
+            }
+        }
+
+    private:
+        OutputSink& next_;
+        char buf_[N];
+        size_t pos_{0};
+};
+
+/**
+ * @brief 작은 조각들을 N바이트까지 모았다가 next에 한 번에 넘기는 출력 대상
+ *
+ * 터미널처럼 Write() 한 번의 비용(락, 그리기)이 큰 출력 대상 앞에 두어 호출 횟수를 줄인다.
+ * 스택에 N바이트만 사용하므로 출력 길이에 제한이 없다.
+*/
+
+
+
+int VFormat(OutputSink& sink, const char* format, va_list ap);
+int Format(OutputSink& sink, const char* format, ...) __attribute__((format(printf, 2, 3)));
+int FormatArgs(OutputSink& sink, const char* format, const uint64_t* args, int num_args);
+int CaptureArgs(const char* format, va_list ap, uint64_t* args, int max_args);
+
+int VSNPrintf(char* buf, size_t size, const char* format, va_list ap);
+int SNPrintf(char* buf, size_t size, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief printf 형식의 문자열을 변환하여 sink로 바로 흘려보낸다.
+ *
+ * 지원하는 형식:
+ *  플래그 '-', '0', '+', ' ', '#', 폭과 정밀도(숫자 또는 '*'),
+ *  길이 수식어 hh, h, l, ll, z, j, t, 변환 문자 d i u x X o c s p %
+ *  부동소수점(%f 등)은 지원하지 않으며, 지원하지 않는 지정자는 문자 그대로 출력된다.
+ *
+ * VFormat(), Format():
+ *  가변 인자로 변환한다. 반환값은 출력한 글자 수이다.
+ *
+ * FormatArgs():
+ *  Log()가 링에 저장해둔 64비트 인자 배열로 변환한다. '*'도 인자 하나를 소비한다.
+ *
+ * CaptureArgs():
+ *  FormatArgs()에 넘길 인자 배열을 만든다. 변환기와 같은 방식으로 형식 문자열을 해석하여
+ *  길이 수식어에 맞는 형식(int, long, 포인터)으로 가변 인자를 읽고 64비트로 넓혀 저장한다.
+ *  최대 max_args개까지 저장하며, 저장한 인자의 수를 반환한다.
+ *
+ * VSNPrintf(), SNPrintf():
+ *  vsnprintf와 같다. 최대 size - 1글자와 '\0'을 쓰고, 버퍼가 충분했다면
+ *  썼을 글자 수를 반환한다. 반환값이 size 이상이라면 출력이 잘린 것이다.
+ *
+ * PLUS:
+ *  newlib의 vsprintf 대신 직접 변환하는 이유:
+ *      vsprintf는 출력 길이를 제한하지 않아 2KiB 스택 버퍼를 넘치게 할 수 있고,
+ *      결과를 버퍼에 모은 뒤 다시 터미널로 넘기므로 데이터를 두 번 훑는다. 또한 newlib의
+ *      vfprintf는 FILE 구조체, 로케일, 부동소수점 처리를 거쳐 %d 하나에도 비용이 크다.
+ *      이 변환기는 자주 쓰이는 %d, %x, %s를 별도의 빠른 경로로 처리하고,
+ *      format 속성으로 컴파일 시간에 인자의 형식을 검사받는다.
+*/
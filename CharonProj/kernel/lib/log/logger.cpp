@@ -1,50 +1,198 @@
 // include - local
 #include "logger.hpp"
-#include "../terminal/terminal.hpp"
+#include "format.hpp"
+#include "../interrupt/interrupt.hpp"
+#include "../interrupt/interrupt_asm.h"
 
 
 // include - system
 #include <cstddef>
-#include <cstdio>
 #include <cstdarg>
 
 
 namespace {
     LogLevel log_level = kWarn;  			// 현재의 로그 레벨을 kWarn으로 설정
+    bool log_drain_started = false;         // StartLogDrain() 이후로는 로그를 링에 기록하고 DrainLog()에서 출력한다.
+
+
+    /**
+     * ======== 로그 레코드 링 ========
+    */
+
+    const int kMaxLogArgs = 6;                              // 레코드 하나에 저장할 수 있는 인자의 최대 개수
+    const size_t kLogRingSize = 512;                        // CPU 하나의 링에 저장할 수 있는 레코드 수 (2의 거듭제곱)
+    const int kMaxLogCPUs = 4;                              // 링을 가질 수 있는 CPU의 수
+
+    struct LogRecord {
+        uint64_t sequence;                                  // 기록이 끝났음을 알리는 번호 (위치 + 1)
+        uint64_t timestamp;                                 // 기록한 시각 (TSC)
+        LogLevel level;
+        const char* format;
+        int num_args;                                       // args에 저장된 인자의 수
+        uint64_t args[kMaxLogArgs];
+    };
+
+    struct LogRing {
+        uint64_t head;                                      // 다음에 예약할 위치 (생산자)
+        uint64_t tail;                                      // 다음에 읽을 위치 (소비자)
+        uint64_t dropped;                                   // 링이 가득 차서 버린 레코드 수
+        LogRecord records[kLogRingSize];
+    };
+
+    LogRing log_rings[kMaxLogCPUs];
+
+    /*
+     * 레코드를 예약하는 생산자는 같은 CPU의 일반 코드와 인터럽트 핸들러가 될 수 있으므로
+     * head_는 CAS로 예약하고, 레코드의 내용을 모두 쓴 뒤 sequence를 기록하여 완료를 알린다.
+     * 소비자(DrainLog)는 sequence가 기대한 값일 때만 레코드를 읽는다.
+     */
+
+    LogRing& CurrentRing() {
+        return log_rings[GetLocalAPICID() % kMaxLogCPUs];
+    }
 }
 
-extern Terminal* terminal; 				// 터미널 변수를 설정
+namespace {
+    const int kMaxConsoleSinks = 4;                         // 콘솔에 등록할 수 있는 출력 대상의 최대 개수
+
+    OutputSink* console_sinks[kMaxConsoleSinks];            // 등록된 출력 대상 (터미널, 시리얼 포트 등)
+    int num_console_sinks = 0;
+}
+
+Error AddConsoleSink(OutputSink* sink) {
+    if (num_console_sinks == kMaxConsoleSinks) {
+        return MAKE_ERROR(Error::kFull);
+    }
+    console_sinks[num_console_sinks++] = sink;
+    return MAKE_ERROR(Error::kSuccess);
+}
+
+void ConsoleSink::Write(const char* s, size_t length) {
+    for (int i = 0; i < num_console_sinks; ++i) {
+        console_sinks[i]->Write(s, length);
+    }
+}
 
 void SetLogLevel(LogLevel level) { 			// 로그 레벨을 설정하는 함수, 현재의 로그 레벨을 level인자의 값으로 설정
     log_level = level;
 }
 
-int Log(LogLevel level, const char* format, ...) { 	// 형식화된 로그 메세지를 받아 이를 터미널에 출력하는 함수이다. 
+int Log(LogLevel level, const char* format, ...) { 	// 로그 레코드를 링에 기록하는 함수이다. 출력은 DrainLog()에서 이루어진다.
     if (level > log_level) {
         return 0;
     }
 
-    //가변 인자 목록(va_list)타입 변수
-    va_list ap;
-    int result;
-    char str[2048];
+    if (!__atomic_load_n(&log_drain_started, __ATOMIC_ACQUIRE)) {                  // 1)
+        ConsoleSink console;
+        ChunkedSink<256> sink{console};
+        va_list ap;
+        va_start(ap, format);
+        const int result = VFormat(sink, format, ap);
+        va_end(ap);
+        return result;
+    }
 
+    auto& ring = CurrentRing();
 
-    /**
-     * @brief vsprintf를 이용한 문자열 저징 맞 출력
-     * 
-     * 동작방식[I1] : 
-     * 동작방식[I2] : 
-     * 동작방식[I3] : 
-     * 동작방식[IV] : 
-     * 동작방식[V1] : 
-    */
+    uint64_t head = __atomic_load_n(&ring.head, __ATOMIC_RELAXED);                 // 2)
+    do {
+        if (head - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE) >= kLogRingSize) {
+            __atomic_fetch_add(&ring.dropped, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+    } while (!__atomic_compare_exchange_n(
+        &ring.head, &head, head + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
 
+    auto& record = ring.records[head % kLogRingSize];                               // 3)
+    record.timestamp = ReadTSC();
+    record.level = level;
+    record.format = format;
 
+    va_list ap;                                                                     // 4)
     va_start(ap, format);
-    result = vsprintf(str, format, ap);
+    const int num_args = CaptureArgs(format, ap, record.args, kMaxLogArgs);
     va_end(ap);
+    record.num_args = num_args;
+
+    __atomic_store_n(&record.sequence, head + 1, __ATOMIC_RELEASE);                 // 5)
+    return num_args;
+}
+
+/**
+ * @brief 로그를 문자열로 변환하지 않고 바이너리 레코드로 링에 저장한다.
+ * 
+ * 동작방식:
+ *  1) StartLogDrain()이 호출되기 전(메인 루프 전)에는 링에 기록하지 않고 바로 변환하여 콘솔에 출력한다.
+ *     부팅 초기에 멈추거나 exit()하는 경로에서 DrainLog()가 호출되지 않아도 메시지가 사라지지 않는다.
+ * 
+ *  2) CAS로 링의 위치 하나를 예약한다. 링이 가득 찼다면 레코드를 버리고 dropped를 증가시킨다.
+ *     같은 CPU에서 인터럽트 핸들러가 끼어들어도 서로 다른 위치를 예약하므로 락이 필요 없다.
+ * 
+ *  3) 예약한 위치에 시각, 레벨, 형식 문자열의 포인터를 기록한다.
+ * 
+ *  4) CaptureArgs()로 변환 지정자마다 길이 수식어에 맞는 형식(int, long, 포인터)으로 인자를 읽고,
+ *     64비트로 넓혀 저장한다. 형식 문자열의 해석은 FormatArgs()와 같다.
+ * 
+ *  5) sequence를 기록하여 소비자에게 레코드가 완성되었음을 알린다.
+ * 
+ * PLUS:
+ *  주의사항:
+ *      형식 문자열과 %s 인자는 출력될 때까지 유지되어야 한다. 
+ *      문자열 리터럴이나 Error::Name(), Error::File()처럼 정적인 문자열만 전달해야 하며,
+ *      스택 버퍼를 %s로 넘기면 안 된다. 부동소수점 인자는 지원하지 않는다.
+*/
+
+
+void StartLogDrain() {
+    DrainLog();
+    __atomic_store_n(&log_drain_started, true, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 이후의 Log()를 링에 기록하도록 바꾼다.
+ * 
+ * 메인 루프가 DrainLog()를 주기적으로 호출하기 시작할 때 한 번 호출한다.
+*/
+
+
+void DrainLog() {
+    for (auto& ring : log_rings) {
+        ConsoleSink console;
+        ChunkedSink<256> sink{console};
+
+        while (true) {
+            const uint64_t tail = ring.tail;
+            auto& record = ring.records[tail % kLogRingSize];
 
-    terminal->printString(str); 			// 터미널의 printString() 함수를 사용해서 터미널에 결과를 출력한다.
-    return result; 					        // 문자열의 길이를 반환 
+            if (__atomic_load_n(&record.sequence, __ATOMIC_ACQUIRE) != tail + 1) {     // 1)
+                break;
+            }
+
+            FormatArgs(sink, record.format, record.args, record.num_args);             // 2)
+            __atomic_store_n(&ring.tail, tail + 1, __ATOMIC_RELEASE);                   // 3)
+        }
+
+        const uint64_t dropped = __atomic_exchange_n(&ring.dropped, 0, __ATOMIC_RELAXED);
+        if (dropped > 0) {                                                              // 4)
+            Format(sink, "[log] %lu records dropped\n", dropped);
+        }
+    }
 }
+
+/**
+ * @brief 링에 쌓인 로그 레코드를 문자열로 변환하여 콘솔에 출력한다.
+ * 
+ * 동작방식:
+ *  1) 다음 위치의 레코드가 아직 기록 중이라면(sequence가 다르다면) 이 CPU의 링은 여기까지 처리한다.
+ * 
+ *  2) 레코드에 저장된 형식 문자열과 인자로 변환하여, 결과를 ChunkedSink를 거쳐 콘솔(터미널, 시리얼 포트)로 바로 보낸다.
+ *     중간 문자열 버퍼가 없으므로 긴 로그도 잘리지 않는다.
+ * 
+ *  3) tail을 증가시켜 생산자가 이 위치를 다시 사용할 수 있게 한다.
+ * 
+ *  4) 버려진 레코드가 있었다면 그 수를 출력한다.
+ * 
+ * 글자를 그리는 비용이 큰 터미널 출력은 이 함수에서만 수행되므로, 
+ * Log()의 호출 비용은 형식 문자열을 한 번 훑는 정도로 줄어든다.
+ * 메인 루프가 잠들기 전마다 호출한다.
+*/
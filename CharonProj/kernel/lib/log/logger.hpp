@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include "../error/error.hpp"
+#include "format.hpp"
+
 enum LogLevel {
     kError  = 3,
     kWarn   = 4,
@@ -31,11 +34,70 @@ void SetLogLevel(LogLevel level);
  * 매개변수[I2] : const char* format -> 로그 메세지의 형식 문자열 (printf 형식을 따름)
  * 매개변수[I3] : '...' -> 가변 인자 목록
  * 
- * 반환할값 : 로그 메세지가 성공적으로 기록될 경우 기록된 문자 수를 반환
+ * 반환할값 : 로그 레코드에 저장된 인자의 수, 기록되지 않은 경우 0을 반환
+ *            (StartLogDrain() 전이라면 바로 출력한 글자 수)
  * 
  * 동작방식[I1] : 설정된 로그 임계값보다 높은 우선 순위의 로그만 기록
- * 동작방식[I2] : format과 가변 인자들을 사용하여 로그 메세지를 형성 & 기록
+ * 동작방식[I2] : format의 포인터와 가변 인자들을 CPU별 로그 링에 바이너리 레코드로 기록
  * 동작방식[I3] : 로그는 설정된 임계값 이상의 우선 순위를 가진 경우만 기록, 나머지는 무시
- * 동작방식[IV] : 반환 값은 로그가 기록된 문자의 수
+ * 동작방식[IV] : 문자열로의 변환과 출력은 DrainLog()에서 나중에 수행
+ * 동작방식[V]  : StartLogDrain()이 호출되기 전(부팅 초기)에는 링을 거치지 않고 바로 출력
+ * 
+ * 주의 : format과 %s 인자는 DrainLog()가 호출될 때까지 유효한 정적 문자열이어야 한다.
+*/
+int Log(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+
+/**
+ * @brief AddConsoleSink함수 : 로그와 printk의 출력을 받을 출력 대상(콘솔)을 추가
+ * 
+ * 매개변수 : OutputSink* sink -> 추가할 출력 대상 (터미널, 시리얼 포트 등)
+ * 
+ * 반환할값 : 최대 개수(kMaxConsoleSinks)를 넘으면 kFull
+ * 
+ * 동작방식 : DrainLog()와 printk()는 변환한 글자열을 등록된 순서대로 모든 출력 대상에 쓴다.
+ *           터미널이 멈추거나 화면이 없는 환경에서도 시리얼 포트로 로그를 받을 수 있다.
+*/
+Error AddConsoleSink(OutputSink* sink);
+
+
+class ConsoleSink : public OutputSink {
+    public:
+        virtual void Write(const char* s, size_t length) override;
+};
+
+/**
+ * @brief AddConsoleSink()로 등록된 모든 출력 대상에 나누어 쓰는 출력 대상
+ * 
+ * 상태를 갖지 않으므로 필요한 곳에서 지역 변수로 만들어 사용한다.
+ * EX) ConsoleSink console;  ChunkedSink<256> sink{console};
+*/
+
+
+/**
+ * @brief DrainLog함수 : 로그 링에 쌓인 레코드를 문자열로 변환하여 콘솔에 출력
+ * 
+ * 동작방식 : 메인 루프에서 주기적으로 호출하며, 인터럽트 핸들러에서는 호출하지 않는다.
+*/
+void DrainLog();
+
+
+/**
+ * @brief StartLogDrain함수 : 남은 레코드를 출력한 뒤, 이후의 Log()를 링에 기록하도록 전환
+ * 
+ * 동작방식 : 메인 루프가 DrainLog()를 호출하기 시작하기 직전에 한 번 호출한다.
+ *           그 전의 Log()는 DrainLog()가 불리지 않고 멈추더라도 사라지지 않도록 바로 출력된다.
+*/
+void StartLogDrain();
+
+
+/**
+ * @brief printk함수 : 형식 문자열을 변환하여 콘솔에 바로 출력 (main.cpp에 정의)
+ * 
+ * 반환할값 : 출력한 글자 수
+ * 
+ * 동작방식 : Log()와 달리 호출한 즉시 변환하므로, 스택 버퍼를 %s로 넘겨도 된다.
+ * 
+ * format 속성으로 컴파일러가 형식 문자열과 인자의 형식이 맞는지 검사한다.
 */
-int Log(LogLevel level, const char* format, ...);
\ No newline at end of file
+int printk(const char* format, ...) __attribute__((format(printf, 1, 2)));
@@ -5,6 +5,7 @@ BitmapMemoryManager::BitmapMemoryManager()
 {}
 
 ValueWithError<FrameID> BitmapMemoryManager::Allocate(size_t num_frames) {
+    IRQSaveLockGuard guard{lock_};
     size_t start_frame_id = range_begin_.ID();
 
     while(1) {
@@ -23,7 +24,9 @@ ValueWithError<FrameID> BitmapMemoryManager::Allocate(size_t num_frames) {
 
         if (i == num_frames) {
             //num frames
-            MarkAllocated(FrameID{start_frame_id}, num_frames);
+            for (size_t j = 0; j < num_frames; ++j) {
+                SetBit(FrameID{start_frame_id + j}, true);
+            }
 
             return {
                 FrameID{start_frame_id},
@@ -36,6 +39,7 @@ ValueWithError<FrameID> BitmapMemoryManager::Allocate(size_t num_frames) {
 }
 
 Error BitmapMemoryManager::Free(FrameID start_frame, size_t num_frames) {
+    IRQSaveLockGuard guard{lock_};
     for (size_t i = 0; i < num_frames; ++i) {
 
         SetBit(FrameID{start_frame.ID() + i}, false);
@@ -45,6 +49,7 @@ Error BitmapMemoryManager::Free(FrameID start_frame, size_t num_frames) {
 }
 
 void BitmapMemoryManager::MarkAllocated(FrameID start_frame, size_t num_frames) {
+    IRQSaveLockGuard guard{lock_};
 
     for (size_t i = 0; i < num_frames; ++i) {
         SetBit(FrameID{start_frame.ID() + i}, true);
@@ -55,6 +60,7 @@ void BitmapMemoryManager::SetMemoryRange(
     FrameID range_begin, 
     FrameID range_end
 ) {
+    IRQSaveLockGuard guard{lock_};
     range_begin_ = range_begin;
     range_end_ = range_end;
 
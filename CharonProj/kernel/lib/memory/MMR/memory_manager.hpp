@@ -10,6 +10,7 @@
 #include <limits>
 
 #include "../../error/error.hpp"
+#include "../../sync/spinlock.hpp"
 
 namespace {
 
@@ -105,6 +106,9 @@ class BitmapMemoryManager {
             /*  메모리 메니저에서 다루는 메모리 범위의 끝점(최종 프레임 다음의 프레임)  */
             FrameID range_end_;
 
+            /*  alloc_map_과 메모리 범위를 여러 코어와 인터럽트로부터 보호하는 락  */
+            TicketLock lock_;
+
             bool GetBit(FrameID frame) const;
             void SetBit(FrameID frame, bool allocated);
 };
@@ -1,5 +1,6 @@
 #include "mouse.hpp"
 #include "../graphics/graphics.hpp"
+#include "../graphics/cursor_plane.hpp"
 
 namespace {
     const int cursorWidth = 15;
@@ -30,54 +31,36 @@ namespace {
         "         @.@   ",
         "         @@@   ",
     };
+}
 
-    //render mouse cursor
-    void DrawCursor(PixelWriter* pixel_writer, Vector2D<int> position) { 
-        for (int dy = 0; dy < cursorHeight; ++dy) {
-            for (int dx = 0; dx < cursorWidth; ++dx) {
-                if (cursor_shape[dy][dx] == '@') {
-                    pixel_writer->Write(position.x + dx, position.y + dy, {0, 0, 0});
-                } else if (cursor_shape[dy][dx] == '.') {
-                    pixel_writer->Write(position.x + dx, position.y + dy, {255, 255, 255});
-                }
-            }
-        }
-    }
 
-    void EraseCursor(
-        PixelWriter* pixel_writer, Vector2D<int> position,
-        PixelColor erase_color
-    ) {
-        for (int dy = 0; dy < cursorHeight; ++dy) {
-            for (int dx = 0; dx < cursorWidth; ++dx) {
-                if (cursor_shape[dy][dx] != ' ') {
-                    pixel_writer->Write(position.x + dx, position.y + dy, erase_color);
-                }
+//define mouse_class
+MouseCursor::MouseCursor(BackBuffer* back_buffer, Vector2D<int> initial_position)
+    : back_buffer_{back_buffer},
+      plane_{*back_buffer, {cursorWidth, cursorHeight}, {back_buffer->Width(), back_buffer->Height()}}
+{
+    for (int dy = 0; dy < cursorHeight; ++dy) {
+        for (int dx = 0; dx < cursorWidth; ++dx) {
+            if (cursor_shape[dy][dx] == '@') {
+                plane_.SetPixel(dx, dy, {0, 0, 0});
+            } else if (cursor_shape[dy][dx] == '.') {
+                plane_.SetPixel(dx, dy, {255, 255, 255});
             }
         }
     }
-}
-
+    plane_.Move(initial_position);
 
-//define mouse_class
-MouseCursor::MouseCursor(
-    PixelWriter* writer, PixelColor erase_color,
-        Vector2D<int> initial_position
-) : pixel_writer_{writer},
-    erase_color_{erase_color},
-    position_{initial_position}
-{
-    DrawCursor(pixel_writer_, position_);
+    back_buffer_->SetCursorPlane(&plane_);
+    back_buffer_->Flush();
 }
 
 void MouseCursor::MoveRelative(Vector2D<int> displacement) {
-    //1. 이전 위치의 픽셀 초기화
-    EraseCursor(pixel_writer_, position_, erase_color_);
-
-    //2. 새 위치로 이동
-    position_ += displacement;
-
-    //3. 새 위치 좌표에 커서 생성
-    DrawCursor(pixel_writer_, position_);
+    plane_.MoveRelative(displacement);
 }
 
+/*
+ * 커서 모양은 생성할 때 한 번만 프레임 버퍼 형식으로 변환해 커서 평면에 저장한다.
+ * 이동은 커서 평면의 위치만 바꾸며, 지우기와 그리기는 BackBuffer::Flush()가 
+ * 커서 아래 픽셀을 되돌리고 새 위치에 커서를 그리는 방식으로 처리한다.
+ *
+ */
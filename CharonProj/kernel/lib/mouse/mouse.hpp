@@ -5,25 +5,26 @@
 #pragma once
 
 #include "../graphics/graphics.hpp"
+#include "../graphics/back_buffer.hpp"
+#include "../graphics/cursor_plane.hpp"
 
 class MouseCursor { 						            // 마우스의 위치와 이동을 정의하는 마우스 클래스이다.
     public:
-        MouseCursor(
-            PixelWriter* writer, PixelColor erase_color,
-            Vector2D<int> initial_position
-        );
+        MouseCursor(BackBuffer* back_buffer, Vector2D<int> initial_position);
         void MoveRelative(Vector2D<int> displacement);
+        Vector2D<int> Position() const {  return plane_.Position();  }
 
 	/*
 	 * MouseCursor() :
-	 * 	PixelWriter(graphics.hpp에 정의), 지울 색상, 초기 위치를 받는 생성자이다.
+	 * 	커서를 그릴 BackBuffer와 초기 위치를 받는 생성자이다. 
+	 * 	커서 모양으로 커서 평면(CursorPlane)을 만들어 BackBuffer에 등록한다.
 	 *
 	 * MoveRelative() : 
-	 * 	현 위치와 이동할 위치를 고려하여 마우스의 이동을 전담하는 함수이다.
+	 * 	커서 평면의 위치만 옮긴다. 실제로 화면에 반영되는 것은 다음 BackBuffer::Flush()이므로,
+	 * 	한 프레임 동안 여러 번 호출되어도 커서는 한 번만 다시 그려진다.
 	 * */
 
     private:   
-        PixelWriter* pixel_writer_ = nullptr; 			// PixelWriter를 지시하는 포인터이다.
-        PixelColor erase_color_; 				        // MouseCursor() 생성자에서 사용되는 erase_color_를 정의한 것이다.
-        Vector2D<int> position_; 				        // 마우스 커서의 현재 위치를 나타내는 변수이다.
+        BackBuffer* back_buffer_ = nullptr; 			// 커서 평면을 등록한 BackBuffer를 지시하는 포인터이다.
+        CursorPlane plane_; 				            // 커서 이미지, 위치, 커서 아래 픽셀을 가진 커서 평면이다.
 };
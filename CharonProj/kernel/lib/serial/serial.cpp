@@ -0,0 +1,221 @@
+/**
+ * @file serial.cpp
+*/
+
+#include "serial.hpp"
+#include "../io/io_func.h"
+
+
+namespace {
+    /*  base로부터의 레지스터 오프셋  */
+    const uint16_t kData = 0;                       // THR(쓰기), RBR(읽기), DLAB = 1이면 분주비 하위 바이트
+    const uint16_t kInterruptEnable = 1;            // IER, DLAB = 1이면 분주비 상위 바이트
+    const uint16_t kFifoControl = 2;                // FCR(쓰기), IIR(읽기)
+    const uint16_t kInterruptId = 2;
+    const uint16_t kLineControl = 3;                // LCR
+    const uint16_t kModemControl = 4;               // MCR
+    const uint16_t kLineStatus = 5;                 // LSR
+
+    const uint8_t kLCRDivisorLatch = 0x80;          // DLAB
+    const uint8_t kLCR8N1 = 0x03;                   // 8비트 데이터, 패리티 없음, 정지 비트 1개
+    const uint8_t kFCREnable = 0xc7;                // FIFO 사용, 송수신 FIFO 비우기, 수신 트리거 14바이트
+    const uint8_t kMCRLoopback = 0x1e;              // 루프백 모드 (RTS, OUT1, OUT2)
+    const uint8_t kMCRNormal = 0x0b;                // DTR, RTS, OUT2 (OUT2가 켜져야 IRQ 선이 연결된다)
+    const uint8_t kIERTxEmpty = 0x02;               // ETBEI: 송신 holding 레지스터가 비면 인터럽트
+    const uint8_t kIIRNoInterrupt = 0x01;
+    const uint8_t kIIRFifoEnabled = 0xc0;           // 16550A 이상에서 FIFO가 동작중임을 나타낸다.
+    const uint8_t kLSRTxEmpty = 0x20;               // THRE
+
+    const uint32_t kUARTClock = 115200;             // 분주비가 1일 때의 속도
+}
+
+
+SerialPort::SerialPort(uint16_t base)
+    : base_{base}, present_{false}, interrupt_enabled_{false}, fifo_depth_{1},
+      tx_head_{0}, tx_tail_{0}, dropped_{0}, total_dropped_{0} {
+}
+
+
+Error SerialPort::Initialize(uint32_t baud_rate) {
+    const uint16_t divisor = baud_rate == 0 || baud_rate > kUARTClock ? 1 : kUARTClock / baud_rate;
+
+    WriteIo8(base_ + kInterruptEnable, 0);                                      // 1)
+    WriteIo8(base_ + kLineControl, kLCRDivisorLatch);                           // 2)
+    WriteIo8(base_ + kData, divisor & 0xff);
+    WriteIo8(base_ + kInterruptEnable, divisor >> 8);
+    WriteIo8(base_ + kLineControl, kLCR8N1);
+    WriteIo8(base_ + kFifoControl, kFCREnable);                                 // 3)
+
+    WriteIo8(base_ + kModemControl, kMCRLoopback);                              // 4)
+    WriteIo8(base_ + kData, 0xae);
+    if (ReadIo8(base_ + kData) != 0xae) {
+        return MAKE_ERROR(Error::kNoSerialPort);
+    }
+
+    WriteIo8(base_ + kModemControl, kMCRNormal);                                // 5)
+    fifo_depth_ = (ReadIo8(base_ + kInterruptId) & kIIRFifoEnabled) == kIIRFifoEnabled ? 16 : 1;
+    present_ = true;
+    return MAKE_ERROR(Error::kSuccess);
+}
+
+/**
+ * @brief UART를 초기화하는 함수
+ *
+ * 동작방식:
+ *  1) 초기화하는 동안 인터럽트가 발생하지 않도록 모든 UART 인터럽트를 끈다.
+ *
+ *  2) DLAB을 켜고 분주비를 쓴 뒤, 8N1 형식으로 설정하며 DLAB을 끈다.
+ *
+ *  3) 송수신 FIFO를 켜고 비운다.
+ *
+ *  4) 루프백 모드에서 보낸 바이트가 그대로 돌아오는지 확인한다.
+ *     돌아오지 않는다면 포트가 없는 것이므로 kNoSerialPort를 반환하며, 이후의 Write()는 무시된다.
+ *
+ *  5) 루프백을 끄고 일반 모드로 바꾼다. IIR의 상위 2비트로 FIFO가 실제로 동작하는지(16550A) 확인한다.
+*/
+
+
+void SerialPort::EnableTxInterrupt() {
+    if (!present_) {
+        return;
+    }
+
+    IRQSaveLockGuard guard{lock_};
+    interrupt_enabled_ = true;
+    WriteIo8(base_ + kInterruptEnable, kIERTxEmpty);
+    if (txEmpty()) {
+        fillFifo();
+    }
+}
+
+
+void SerialPort::Write(const char* s, size_t length) {
+    if (!present_) {
+        return;
+    }
+
+    IRQSaveLockGuard guard{lock_};
+    reportDropped();                                                            // 1)
+    for (size_t i = 0; i < length; ++i) {
+        if (s[i] == '\n') {
+            push('\r');
+        }
+        push(s[i]);
+    }
+
+    if (!interrupt_enabled_) {                                                  // 2)
+        while (tx_head_ != tx_tail_) {
+            waitTxEmpty();
+            fillFifo();
+        }
+    } else if (txEmpty()) {                                                     // 3)
+        fillFifo();
+    }
+}
+
+/**
+ * @brief 글자열을 송신 링 버퍼에 넣고 송신을 시작하는 함수
+ *
+ * 동작방식:
+ *  1) 이전에 링 버퍼가 가득 차서 버린 글자가 있었다면, 먼저 그 수를 알리는 메시지를 넣는다.
+ *
+ *  2) 아직 송신 인터럽트를 받지 않는다면 링 버퍼가 빌 때까지 직접 보낸다.
+ *
+ *  3) 송신 FIFO가 비어있다면 송신이 멈춘 상태이므로 FIFO를 채워 다시 시작한다.
+ *     비어있지 않다면 FIFO가 비었을 때 발생하는 인터럽트가 나머지를 보낸다.
+ *     락을 가진 동안에는 인터럽트가 막혀 있으므로, 핸들러와 동시에 FIFO를 채우는 일은 없다.
+*/
+
+
+void SerialPort::OnInterrupt() {
+    IRQSaveLockGuard guard{lock_};
+
+    if (ReadIo8(base_ + kInterruptId) & kIIRNoInterrupt) {                      // 1)
+        return;
+    }
+    if (txEmpty()) {                                                            // 2)
+        fillFifo();
+    }
+}
+
+/**
+ * @brief 송신 인터럽트를 처리하는 함수
+ *
+ * 동작방식:
+ *  1) IIR을 읽으면 THRE 인터럽트가 해제된다. 이 UART가 보낸 인터럽트가 아니라면 돌아간다.
+ *
+ *  2) 송신 FIFO를 링 버퍼의 글자로 채운다. 링 버퍼가 비었다면 아무것도 쓰지 않으며,
+ *     다음 Write()가 송신을 다시 시작할 때까지 인터럽트는 발생하지 않는다.
+*/
+
+
+void SerialPort::Poll() {
+    if (!present_) {
+        return;
+    }
+
+    IRQSaveLockGuard guard{lock_};
+    if (tx_head_ != tx_tail_ && txEmpty()) {
+        fillFifo();
+    }
+}
+
+/*
+ * IRQ가 전달되지 않는 환경(IOAPIC 설정 실패 등)에서도 출력이 멈추지 않도록,
+ * 메인 루프가 잠들기 전에 호출한다. 인터럽트가 동작한다면 대부분 아무것도 하지 않는다.
+ *
+ */
+
+
+void SerialPort::push(char c) {
+    if (tx_head_ - tx_tail_ == kTxBufferSize) {
+        if (interrupt_enabled_) {
+            ++dropped_;
+            ++total_dropped_;
+            return;
+        }
+        waitTxEmpty();
+        fillFifo();
+    }
+    tx_buffer_[tx_head_++ % kTxBufferSize] = c;
+}
+
+/*
+ * 링 버퍼가 가득 찼을 때, 송신 인터럽트를 받는다면 글자를 버리고 그 수를 센다.
+ * lock_을 가진 동안은 인터럽트가 막혀 있으므로, 여기서 UART를 기다리면 그동안 다른 인터럽트도
+ * 처리되지 않는다. 아직 인터럽트를 받지 않는 부팅 초기에는 UART를 직접 polling하여 자리를 만든다.
+ *
+ */
+
+
+void SerialPort::reportDropped() {
+    if (dropped_ == 0) {
+        return;
+    }
+
+    char notice[48];
+    const int length = SNPrintf(notice, sizeof(notice), "\r\n[serial] %lu bytes dropped\r\n", dropped_);
+    if (kTxBufferSize - (tx_head_ - tx_tail_) < static_cast<size_t>(length)) {
+        return;
+    }
+    for (int i = 0; i < length; ++i) {
+        tx_buffer_[tx_head_++ % kTxBufferSize] = notice[i];
+    }
+    dropped_ = 0;
+}
+
+void SerialPort::fillFifo() {
+    for (int i = 0; i < fifo_depth_ && tx_tail_ != tx_head_; ++i) {
+        WriteIo8(base_ + kData, tx_buffer_[tx_tail_++ % kTxBufferSize]);
+    }
+}
+
+bool SerialPort::txEmpty() const {
+    return ReadIo8(base_ + kLineStatus) & kLSRTxEmpty;
+}
+
+void SerialPort::waitTxEmpty() const {
+    while (!txEmpty()) {
+        CPURelax();
+    }
+}
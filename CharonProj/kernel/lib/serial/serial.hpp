@@ -0,0 +1,63 @@
+/**
+ * @file serial.hpp
+ *
+ * 16550 호환 UART(COM1)를 커널 콘솔로 사용하는 시리얼 포트 드라이버를 정의한다.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "../error/error.hpp"
+#include "../log/format.hpp"
+#include "../sync/spinlock.hpp"
+
+class SerialPort : public OutputSink {
+    public:
+        static const uint16_t kCOM1 = 0x3f8;                            // COM1의 I/O 포트 기본 주소이다.
+        static const uint8_t kCOM1IRQ = 4;                              // COM1이 연결된 ISA IRQ 번호이다.
+        static const size_t kTxBufferSize = 16384;                      // 송신 링 버퍼의 크기이다. (2의 거듭제곱)
+
+        explicit SerialPort(uint16_t base);
+
+        Error Initialize(uint32_t baud_rate);                           // 속도와 8N1 형식, FIFO를 설정하고 포트가 있는지 확인한다.
+        void EnableTxInterrupt();                                       // 송신 FIFO가 비었을 때 인터럽트를 받도록 설정한다.
+        virtual void Write(const char* s, size_t length) override;      // 글자열을 송신 링 버퍼에 넣는다. (OutputSink)
+        void OnInterrupt();                                             // 인터럽트 핸들러에서 호출하여 송신 FIFO를 채운다.
+        void Poll();                                                    // 송신부가 비어있다면 송신 FIFO를 채운다. (메인 루프에서 호출)
+
+        bool Present() const {  return present_;  }
+        uint64_t Dropped() const {  return total_dropped_;  }           // 링 버퍼가 가득 차서 버린 바이트 수이다.
+
+    private:
+        void push(char c);                                              // 글자 하나를 링 버퍼에 넣는다. (lock_을 가진 상태에서 호출)
+        void reportDropped();                                           // 버린 바이트가 있었다면 그 수를 링 버퍼에 알린다.
+        void fillFifo();                                                // 링 버퍼에서 송신 FIFO로 최대 fifo_depth_바이트를 옮긴다.
+        bool txEmpty() const;                                           // 송신 holding 레지스터(FIFO)가 비어있는지 확인한다.
+        void waitTxEmpty() const;
+
+        const uint16_t base_; 						                    // UART 레지스터의 I/O 포트 기본 주소이다.
+        bool present_; 						                            // 초기화에 성공한 포트인지의 여부이다.
+        bool interrupt_enabled_; 					                    // 송신 인터럽트로 FIFO를 채우는지의 여부이다.
+        int fifo_depth_; 						                        // 한 번에 쓸 수 있는 송신 FIFO의 크기이다. (16550A는 16, 8250은 1)
+
+        char tx_buffer_[kTxBufferSize]; 				                // 아직 UART로 보내지 않은 글자를 담는 링 버퍼이다.
+        size_t tx_head_, tx_tail_; 					                // 링 버퍼의 쓰기, 읽기 위치이다. (단조 증가)
+        uint64_t dropped_; 						                        // 마지막으로 알린 뒤 버린 바이트 수이다.
+        uint64_t total_dropped_; 					                    // 지금까지 버린 바이트 수이다.
+        SpinLock lock_;                                                 // 인터럽트 핸들러와 링 버퍼를 함께 사용하므로 IRQSaveLockGuard로 얻는다.
+};
+
+/*
+ * 출력은 링 버퍼에 들어간 뒤, 송신 FIFO가 빌 때마다(THRE 인터럽트) 16바이트씩 UART로 나간다.
+ * 따라서 Write()는 UART의 속도를 기다리지 않고 바로 돌아오며, 화면에 그리는 비용도 없다.
+ *
+ * 인터럽트를 받기 전(EnableTxInterrupt() 이전)에는 Write()가 링 버퍼가 빌 때까지 직접
+ * 송신 FIFO를 채운다(polling). 이때는 링 버퍼가 가득 차도 UART를 직접 polling하여 자리를 만든다.
+ *
+ * 인터럽트를 받은 뒤에 링 버퍼가 가득 찼다면, 인터럽트를 막은 채 UART를 기다리지 않고 글자를 버린다.
+ * 버린 바이트 수는 자리가 난 뒤의 Write()가 "[serial] N bytes dropped"로 알린다.
+ *
+ * '\n'은 시리얼 터미널에서 줄의 처음으로 돌아가도록 "\r\n"으로 바꾸어 보낸다.
+ *
+ * */
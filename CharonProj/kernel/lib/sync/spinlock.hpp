@@ -0,0 +1,339 @@
+/**
+ * @file spinlock.hpp
+ *
+ * 멀티 코어 환경에서 사용할 스핀락, 티켓 락, reader-writer 락과
+ * 인터럽트를 함께 막는 RAII 락 가드를 정의한다.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+
+/**
+ * ======== CPU 보조 함수 ========
+*/
+
+inline void CPURelax() {
+    __asm__ volatile("pause" ::: "memory");
+}
+/**
+ * @brief 스핀 루프 안에서 호출하는 pause 명령
+ *
+ * 하이퍼스레딩 환경에서 같은 코어의 다른 스레드에 실행 자원을 양보하고,
+ * 루프를 빠져나올 때 메모리 순서 위반으로 인한 파이프라인 비우기를 줄여준다.
+*/
+
+inline uint64_t SaveAndDisableInterrupts() {
+    uint64_t rflags;
+    __asm__ volatile("pushfq\n\tpop %0\n\tcli" : "=r"(rflags) :: "memory");
+    return rflags;
+}
+
+inline void RestoreInterrupts(uint64_t rflags) {
+    if (rflags & (1u << 9)) {
+        __asm__ volatile("sti" ::: "memory");
+    }
+}
+/**
+ * @brief 인터럽트 허가 상태를 저장하고 인터럽트를 막는다 / 저장된 상태로 되돌린다.
+ *
+ * 단순히 cli, sti를 짝지어 사용하면 이미 인터럽트가 막힌 상태(인터럽트 핸들러 등)에서
+ * 호출되었을 때 sti가 인터럽트를 잘못 허가하게 된다. 따라서 RFLAGS의 IF(9번 비트)를
+ * 저장해두었다가, 원래 허가된 상태였을 때만 sti를 실행한다.
+*/
+
+
+
+/**
+ * ======== 락 경합 통계 ========
+*/
+
+struct LockStats {
+    uint64_t contended{0};                      // 락을 바로 얻지 못하고 기다린 횟수
+    uint64_t spins{0};                          // 기다리는 동안 반복한 스핀 루프의 총 횟수
+
+    void Record(uint64_t num_spins) {
+        __atomic_fetch_add(&contended, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&spins, num_spins, __ATOMIC_RELAXED);
+    }
+};
+
+/**
+ * @brief 락의 경합 정도를 기록한다.
+ *
+ * 락을 바로 얻은 경우(fast path)에는 아무것도 기록하지 않으므로,
+ * 경합이 없는 상황에서는 통계로 인한 비용이 발생하지 않는다.
+*/
+
+
+
+/**
+ * ======== 스핀락 ========
+*/
+
+class SpinLock {
+    public:
+        void Lock() {
+            if (!__atomic_exchange_n(&locked_, true, __ATOMIC_ACQUIRE)) {   // 1)
+                return;
+            }
+
+            uint64_t spins = 0;
+            do {
+                while (__atomic_load_n(&locked_, __ATOMIC_RELAXED)) {       // 2)
+                    CPURelax();
+                    ++spins;
+                }
+            } while (__atomic_exchange_n(&locked_, true, __ATOMIC_ACQUIRE));
+            stats_.Record(spins);
+        }
+
+        bool TryLock() {
+            return !__atomic_load_n(&locked_, __ATOMIC_RELAXED)
+                && !__atomic_exchange_n(&locked_, true, __ATOMIC_ACQUIRE);
+        }
+
+        void Unlock() {
+            __atomic_store_n(&locked_, false, __ATOMIC_RELEASE);
+        }
+
+        const LockStats& Stats() const {  return stats_;  }
+
+    private:
+        bool locked_{false};
+        LockStats stats_;
+};
+
+/**
+ * @brief test-and-test-and-set 방식의 가장 단순한 스핀락
+ *
+ * 동작방식:
+ *  1) exchange로 락을 얻어본다. 성공하면 바로 반환한다.
+ *
+ *  2) 실패하면 락이 풀릴 때까지 읽기만 반복한다. 읽기는 캐시 라인을 공유 상태로
+ *     유지하므로 다른 코어의 캐시를 계속 무효화하지 않는다.
+ *
+ * 공정성을 보장하지 않으므로, 경합이 심한 곳에는 TicketLock을 사용한다.
+ *
+ * PLUS:
+ *  std::atomic 대신 __atomic 내장 함수를 사용하는 이유:
+ *      커널에 링크되는 libc++는 스레드를 지원하지 않도록 빌드되어 있어 <atomic>을 
+ *      포함할 수 없다. __atomic_* 함수는 컴파일러가 직접 lock 접두사가 붙은 
+ *      명령어로 변환하므로 라이브러리 없이 사용할 수 있다.
+*/
+
+
+
+class TicketLock {
+    public:
+        void Lock() {
+            const uint32_t ticket = __atomic_fetch_add(&next_, 1, __ATOMIC_RELAXED);   // 1)
+            if (__atomic_load_n(&serving_, __ATOMIC_ACQUIRE) == ticket) {
+                return;
+            }
+
+            uint64_t spins = 0;
+            while (__atomic_load_n(&serving_, __ATOMIC_ACQUIRE) != ticket) {           // 2)
+                CPURelax();
+                ++spins;
+            }
+            stats_.Record(spins);
+        }
+
+        bool TryLock() {
+            uint32_t serving = __atomic_load_n(&serving_, __ATOMIC_RELAXED);
+            uint32_t expected = serving;
+            return __atomic_compare_exchange_n(
+                &next_, &expected, serving + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+            );
+        }
+
+        void Unlock() {
+            __atomic_store_n(                                                           // 3)
+                &serving_, __atomic_load_n(&serving_, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE
+            );
+        }
+
+        bool IsLocked() const {
+            return __atomic_load_n(&next_, __ATOMIC_RELAXED)
+                != __atomic_load_n(&serving_, __ATOMIC_RELAXED);
+        }
+
+        const LockStats& Stats() const {  return stats_;  }
+
+    private:
+        uint32_t next_{0};                          // 다음에 발급할 번호표
+        uint32_t serving_{0};                       // 현재 락을 가진 번호표
+        LockStats stats_;
+};
+
+/**
+ * @brief 번호표(ticket)를 이용하여 도착한 순서대로 락을 넘겨주는 공정한 스핀락
+ *
+ * 동작방식:
+ *  1) next_를 원자적으로 증가시켜 자신의 번호표를 받는다.
+ *
+ *  2) serving_이 자신의 번호가 될 때까지 기다린다.
+ *
+ *  3) 락을 해제할 때는 serving_을 1 증가시켜 다음 번호표를 가진 코어에게 락을 넘긴다.
+ *     serving_은 락을 가진 코어만 변경하므로 load + store로 충분하다.
+ *
+ * PLUS:
+ *  티켓 락을 사용하는 이유:
+ *      단순 스핀락은 락이 풀리는 순간 모든 대기자가 동시에 exchange를 시도하므로,
+ *      특정 코어가 계속 락을 얻지 못하는 기아(starvation) 상태가 발생할 수 있다.
+ *      티켓 락은 FIFO 순서를 보장하여 이 문제를 해결한다.
+*/
+
+
+
+/**
+ * ======== Reader-Writer 락 ========
+*/
+
+class RWLock {
+    public:
+        void LockShared() {
+            uint64_t spins = 0;
+            while (true) {
+                while (__atomic_load_n(&writer_, __ATOMIC_RELAXED)) {       // 1)
+                    CPURelax();
+                    ++spins;
+                }
+
+                __atomic_fetch_add(&readers_, 1, __ATOMIC_ACQUIRE);         // 2)
+                if (!__atomic_load_n(&writer_, __ATOMIC_ACQUIRE)) {
+                    break;
+                }
+                __atomic_fetch_sub(&readers_, 1, __ATOMIC_RELEASE);         // 3)
+            }
+
+            if (spins) {
+                stats_.Record(spins);
+            }
+        }
+
+        void UnlockShared() {
+            __atomic_fetch_sub(&readers_, 1, __ATOMIC_RELEASE);
+        }
+
+        void Lock() {
+            uint64_t spins = 0;
+            while (__atomic_exchange_n(&writer_, true, __ATOMIC_ACQUIRE)) { // 4)
+                CPURelax();
+                ++spins;
+            }
+
+            while (__atomic_load_n(&readers_, __ATOMIC_ACQUIRE) != 0) {     // 5)
+                CPURelax();
+                ++spins;
+            }
+
+            if (spins) {
+                stats_.Record(spins);
+            }
+        }
+
+        void Unlock() {
+            __atomic_store_n(&writer_, false, __ATOMIC_RELEASE);
+        }
+
+        const LockStats& Stats() const {  return stats_;  }
+
+    private:
+        uint32_t readers_{0};
+        bool writer_{false};
+        LockStats stats_;
+};
+
+/**
+ * @brief 여러 reader의 동시 접근과 하나의 writer의 단독 접근을 허용하는 락
+ *
+ * 동작방식:
+ *  1) reader는 writer가 없어질 때까지 기다린다.
+ *
+ *  2) reader 수를 증가시킨 뒤 그 사이에 writer가 들어오지 않았는지 다시 확인한다.
+ *
+ *  3) writer가 먼저 들어왔다면 reader 수를 되돌리고 처음부터 다시 시도한다.
+ *
+ *  4) writer는 writer_ 플래그를 먼저 세운다. 이후 새로운 reader는 1)에서 대기하게 된다.
+ *
+ *  5) 이미 들어와 있는 reader가 모두 빠져나갈 때까지 기다린다.
+ *
+ * writer가 플래그를 세우는 순간부터 새로운 reader를 막으므로 writer가 굶지 않는다.
+*/
+
+
+
+/**
+ * ======== RAII 락 가드 ========
+*/
+
+template <typename Lock>
+class LockGuard {
+    public:
+        explicit LockGuard(Lock& lock) : lock_{lock} {  lock_.Lock();  }
+        ~LockGuard() {  lock_.Unlock();  }
+
+        LockGuard(const LockGuard&) = delete;
+        LockGuard& operator=(const LockGuard&) = delete;
+
+    private:
+        Lock& lock_;
+};
+
+template <typename Lock>
+class IRQSaveLockGuard {
+    public:
+        explicit IRQSaveLockGuard(Lock& lock)
+            : lock_{lock}, rflags_{SaveAndDisableInterrupts()} {
+            lock_.Lock();
+        }
+
+        ~IRQSaveLockGuard() {
+            lock_.Unlock();
+            RestoreInterrupts(rflags_);
+        }
+
+        IRQSaveLockGuard(const IRQSaveLockGuard&) = delete;
+        IRQSaveLockGuard& operator=(const IRQSaveLockGuard&) = delete;
+
+    private:
+        Lock& lock_;
+        uint64_t rflags_;
+};
+
+class SharedLockGuard {
+    public:
+        explicit SharedLockGuard(RWLock& lock) : lock_{lock} {  lock_.LockShared();  }
+        ~SharedLockGuard() {  lock_.UnlockShared();  }
+
+        SharedLockGuard(const SharedLockGuard&) = delete;
+        SharedLockGuard& operator=(const SharedLockGuard&) = delete;
+
+    private:
+        RWLock& lock_;
+};
+
+/**
+ * @brief 스코프를 벗어날 때 자동으로 락을 해제하는 RAII 가드
+ *
+ * LockGuard:
+ *  인터럽트 핸들러에서 사용하지 않는 자료구조를 보호할 때 사용한다.
+ *
+ * IRQSaveLockGuard:
+ *  인터럽트 핸들러와 공유하는 자료구조를 보호할 때 사용한다. 락을 가진 상태에서
+ *  같은 코어에 인터럽트가 들어와 핸들러가 같은 락을 기다리면 교착 상태가 되므로,
+ *  락을 얻기 전에 인터럽트를 막고 해제한 뒤에 원래 상태로 되돌린다.
+ *
+ * SharedLockGuard:
+ *  RWLock을 reader로서 얻는다. writer는 LockGuard<RWLock>을 사용한다.
+ *
+ * EX)
+ *  TicketLock lock;
+ *  {
+ *      IRQSaveLockGuard guard{lock};
+ *      // critical section
+ *  }
+*/
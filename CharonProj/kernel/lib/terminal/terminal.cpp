@@ -10,20 +10,46 @@
 #include "../font/font.hpp"
 
 
+namespace {
+    int FitCells(int pixels, int cell, int max_cells) {
+        const int cells = pixels / cell;
+        return cells < 1 ? 1 : (cells > max_cells ? max_cells : cells);
+    }
+
+    int HistoryLinesFor(int columns) {
+        const int lines = Terminal::kHistoryCells / columns;
+        return lines > Terminal::kHistoryLines ? Terminal::kHistoryLines : lines;
+    }
+
+    static_assert(Terminal::kHistoryCells >= Terminal::kMaxRows * Terminal::kMaxColumns,
+                  "the history ring must hold at least one screen");
+}
+
+
 
 //Terminal-class constructor
 Terminal::Terminal(
-    PixelWriter& writer, const PixelColor& fg_color, 
-            const PixelColor& bg_color 
-) : writer_{writer}, fg_color_{fg_color}, bg_color_{bg_color},
-    buffer_{}, cursor_row_{0}, cursor_column_{0} {
-
+    NativePixelWriter& writer, const Rectangle<int>& area,
+            const PixelColor& fg_color, const PixelColor& bg_color
+) : writer_{&writer}, fg_color_{fg_color}, bg_color_{bg_color}, area_{area},
+    rows_{FitCells(area.size.y, kGlyphHeight, kMaxRows)},
+    columns_{FitCells(area.size.x, kGlyphWidth, kMaxColumns)},
+    wrapped_{}, history_lines_{HistoryLinesFor(columns_)}, top_{0}, num_lines_{rows_}, view_offset_{0},
+    cursor_row_{0}, cursor_column_{0},
+    pending_scroll_{0}, full_redraw_{false}, deferred_{false} {
+        std::fill_n(history_, kHistoryCells, U' ');
+        dirty_begin_.fill(kMaxColumns);
+        dirty_end_.fill(0);
+        glyphs_.Build(writer, fg_color_, &bg_color_);
     }
 
     /*
-     * PixelWriter, foreground_color, background_color에 해당하는 인자를 받고
-     * 이를 이용해서 writer_, fg_color_, bg_color_와 함께 버퍼를 0으로 
-     * 커서 위치를 각각 0으로 초기화하는 Terminal 생성자이다.
+     * PixelWriter, 터미널이 차지할 화면 영역, foreground_color, background_color에 해당하는 인자를 받고
+     * 영역에 들어가는 만큼의 행과 열로 터미널의 크기를 정한다. 링 버퍼는 빈 칸(' ')으로,
+     * 커서 위치는 각각 0으로 초기화한다.
+     *
+     * 글자는 항상 bg_color_ 위에 그려지므로, 배경까지 채운 불투명한 글리프 캐시를 만든다.
+     * 빈 칸도 ' ' 글리프로 그리면 배경색으로 채워진다.
      *
      */
 
@@ -32,84 +58,434 @@ Terminal::Terminal(
 
 
 void Terminal::printString(const char* s) {
-    while(*s)
-    {
-        if(*s == '\n') { 											// 1)
-            newLine();
-        } else if (cursor_column_ < tVertical - 1) { 								// 2)
-            WriteAscii(writer_, 8*cursor_column_, 16*cursor_row_, *s, fg_color_); 	// 3)
-            buffer_[cursor_row_][cursor_column_] = *s; 								// 4)
-            ++cursor_column_; 											// 5)
-        }
-        ++s; 													// 6)
+    Write(s, strlen(s));
+}
+
+void Terminal::Write(const char* s, size_t length) {
+    IRQSaveLockGuard guard{lock_};
+
+    if (view_offset_ != 0) { 										// 1)
+        view_offset_ = 0;
+        full_redraw_ = true;
+    }
+
+    for (size_t i = 0; i < length; ++i) { 									// 2)
+        decoder_.Feed(static_cast<uint8_t>(s[i]), [this](char32_t c) {  put(c);  });
+    }
+
+    if (!deferred_) { 												// 3)
+        render();
+        writer_->Flush();
     }
 }
 
 /*
- * 터미널에 한 줄로 문자열을 작성하는 함수이다.
- * 현재 개행 문자 중 '\n'이 구현되었다.
+ * 터미널에 문자열을 작성하는 함수이다.
+ * printk()와 DrainLog()는 형식 변환 결과를 OutputSink로서 Write()에 바로 넘긴다.
  *
  * 동작방식:
- * 	1) 만약 문자열에 '\n'이 포함되었다면 newLine()함수를 이용해서 한 줄 밑으로 이동한다.
- * 	
- * 	2) 만약 커서의 열 위치가 터미널의 최대 열 위치의 -1  보다 작다면(터미널 인덱스는 0부터 시작) 아래의 코드가 동작한다.
+ * 	1) 스크롤백을 보고 있었다면 새 출력이 보이도록 맨 아래로 돌아간다.
  *
- * 	3) WriteAscii함수를 이용해서 터미널에 문자를 쓴다. 이때 폰트의 폭인 8픽셀을 cursor_column_에 곱하고, 
- * 	   폰트의 높이인 16픽셀을 cursor_row_에 곱하여 문자를 작성한다.
+ * 	2) UTF-8을 코드 포인트로 디코딩하고, 글자를 바로 그리지 않고 put()으로 링 버퍼에 저장한다.
+ * 	   여러 바이트로 된 글자가 두 번의 Write()에 나뉘어 들어와도 decoder_가 이어서 디코딩한다.
  *
- * 	4) 현재 위치에 출력된 문자를 버퍼에 저장한다.
+ * 	3) 그리기를 미루지 않는다면 바로 render()로 그리고, writer_가 BackBuffer라면 화면에 반영한다.
+ * 	   미룬다면 다음 Flush()에서 그때까지 쌓인 변경을 한 번에 그린다.
  *
- * 	5) 커서의 열 위치를 한칸 다음 위치로 이동시킨다.
+ */
+
+
+
+void Terminal::put(char32_t c) {
+    if (c == '\n') { 												// 1)
+        newLine();
+        return;
+    }
+
+    int cells = glyphs_.Cells(c);
+    if (cells > columns_) { 											// 2)
+        c = '?';
+        cells = 1;
+    }
+    if (cursor_column_ > 0 && cursor_column_ + cells > columns_) { 					// 3)
+        wrapped_[indexOf(cursor_row_)] = true;
+        newLine();
+    }
+
+    char32_t* line = lineAt(cursor_row_); 								// 4)
+    line[cursor_column_] = c;
+    if (cells == 2) {
+        line[cursor_column_ + 1] = GlyphCache::kWideTail;
+    }
+    markDirty(cursor_row_, cursor_column_, cursor_column_ + cells);
+    cursor_column_ += cells;
+}
+
+/*
+ * 글자 하나를 링 버퍼에 쓰는 함수이다.
  *
- * 	6) 다음 문자로 이동한다.
+ * 동작방식:
+ * 	1) '\n'이라면 newLine()으로 한 줄 밑으로 이동한다.
+ *
+ * 	2) 터미널의 폭이 한 칸뿐이라면 두 칸 글자는 들어갈 줄이 없으므로 '?'로 바꾸어 저장한다.
+ * 	   오른쪽 칸(kWideTail)이 줄 밖(다음 줄의 첫 칸)에 쓰이지 않게 한다.
+ *
+ * 	3) 현재 줄에 글자가 차지할 칸(1 또는 2)이 남지 않았다면 줄이 다음 줄로 이어진다고 
+ * 	   표시(wrapped_)한 뒤 줄을 바꾼다. 이 표시는 터미널의 크기가 바뀔 때 줄을 다시 이어 붙이는 데 사용된다.
+ *
+ * 	4) 현재 위치에 글자를 저장하고(두 칸 글자라면 오른쪽 칸에 kWideTail), 
+ * 	   그 칸들을 dirty로 기록한 뒤 커서를 옮긴다.
  *
  */
 
 
 
+void Terminal::SetWriter(NativePixelWriter& writer) {
+    IRQSaveLockGuard guard{lock_};
+    writer_ = &writer;
+    glyphs_.Build(writer, fg_color_, &bg_color_);
+}
 
-void Terminal::newLine() {
-    cursor_column_ = 0; 											// 1)
-    if (cursor_row_ < tHorizontal - 1) { 									// 2)
-        ++cursor_row_; 
-    } else {
-        for (int y = 0; y < 16*tHorizontal; ++y) { 								// 3)
-            for (int x = 0; x < 8*tVertical; ++x) { 
-                writer_.Write(x, y, bg_color_); 								// 4)
+void Terminal::SetFont(const UnicodeFont* font) {
+    IRQSaveLockGuard guard{lock_};
+    glyphs_.SetFont(font);
+    full_redraw_ = true;
+    if (!deferred_) {
+        render();
+        writer_->Flush();
+    }
+}
+
+/*
+ * 터미널이 그릴 대상을 바꾼다. 부팅 초기에는 프레임 버퍼에 직접 그리다가,
+ * 힙이 준비되어 BackBuffer를 만든 뒤에는 BackBuffer에 그리도록 바꿀 때 사용한다.
+ * 새 writer의 픽셀 형식이 다를 수 있으므로 글리프 캐시를 다시 만든다.
+ *
+ * SetFont()는 힙이 준비된 뒤 유니코드 폰트를 불러왔을 때 호출한다. 이미 저장된 글자는 
+ * 폰트가 없을 때의 칸 수('?', 한 칸)로 저장되어 있으므로, 두 칸 글리프는 왼쪽 절반만 그려진다.
+ *
+ */
+
+
+
+void Terminal::Resize(const Rectangle<int>& area) {
+    IRQSaveLockGuard guard{lock_};
+
+    const int rows = FitCells(area.size.y, kGlyphHeight, kMaxRows); 				// 1)
+    const int columns = FitCells(area.size.x, kGlyphWidth, kMaxColumns);
+    if (rows != rows_ || columns != columns_) {
+        const int old_rows = rows_, old_columns = columns_;
+        rows_ = rows;
+        columns_ = columns;
+        reflow(old_rows, old_columns);
+    }
+
+    writer_->FillRect(area_.pos, area_.size, bg_color_); 						// 2)
+    area_ = area;
+    writer_->FillRect(area_.pos, area_.size, bg_color_);
+    full_redraw_ = true;
+
+    if (!deferred_) {
+        render();
+        writer_->Flush();
+    }
+}
+
+/*
+ * 터미널을 새 화면 영역(픽셀 좌표)으로 옮기거나 크기를 바꾼다.
+ * 해상도가 바뀌었거나, 터미널을 담은 창의 크기가 바뀌었을 때 호출한다.
+ *
+ * 동작방식:
+ * 	1) 영역에 들어가는 행과 열의 수를 구한다. 크기가 바뀌었다면 내용을 다시 줄바꿈한다.
+ *
+ * 	2) 이전 영역과 새 영역을 배경색으로 지우고 화면 전체를 다시 그리게 한다.
+ * 	   새 영역의 오른쪽, 아래쪽에 글자 한 칸보다 작게 남는 부분도 배경색으로 채워진다.
+ *
+ */
+
+
+
+void Terminal::reflow(int old_rows, int old_columns) {
+    const int old_lines = history_lines_; 								// 1)
+    const int oldest = (top_ + old_rows - num_lines_ + old_lines) % old_lines;
+    const int count = num_lines_ - (old_rows - 1 - cursor_row_);
+    char32_t* const cells = history_;
+    char32_t* const cells_end = history_ + kHistoryCells;
+    std::rotate(cells, cells + oldest * old_columns, cells + old_lines * old_columns);
+    std::rotate(wrapped_, wrapped_ + oldest, wrapped_ + old_lines);
+
+    char32_t* stream = cells_end; 									// 2)
+    for (int k = count - 1; k >= 0; --k) {
+        const char32_t* line = cells + k * old_columns;
+        const bool last = k == count - 1;
+
+        int length = last ? cursor_column_ : old_columns;
+        if (!last && !wrapped_[k]) {
+            while (length > 0 && line[length - 1] == ' ') {
+                --length;
             }
         }
-        for (int horizontal = 0; horizontal < tHorizontal - 1; ++horizontal) { 					// 5)
-            memcpy(buffer_[horizontal], buffer_[horizontal + 1], tVertical + 1); 			// 6)
-            print_str(writer_, 0, 16*horizontal, buffer_[horizontal], fg_color_);  	// 7)
+
+        bool line_end = !last && !wrapped_[k];
+        for (int j = length - 1; j >= 0; --j) {
+            if (line[j] == GlyphCache::kWideTail) {
+                continue;
+            }
+            *--stream = line_end ? (line[j] | kLineEnd) : line[j];
+            line_end = false;
+        }
+        if (line_end) {
+            *--stream = U'\n';
         }
-        memset(buffer_[tHorizontal - 1], 0, tVertical + 1); 						// 8)
     }
+
+    const char32_t* next = stream; 									// 3)
+    int lines = 0, column = 0;
+    bool wrapped = false;
+    while (fillRow(next, cells_end, column, wrapped)) {
+        ++lines;
+    }
+    ++lines;
+    history_lines_ = HistoryLinesFor(columns_);
+    const int dropped = lines > history_lines_ ? lines - history_lines_ : 0;
+
+    next = stream; 											// 4)
+    for (int line = 0; line < lines; ++line) {
+        fillRow(next, cells_end, column, wrapped);
+        if (line >= dropped) {
+            std::copy_n(reflow_row_, columns_, cells + (line - dropped) * columns_);
+            wrapped_[line - dropped] = wrapped;
+        }
+    }
+    const int kept = lines - dropped;
+    std::fill(cells + kept * columns_, cells_end, U' ');
+    std::fill(wrapped_ + kept, wrapped_ + kHistoryLines, false);
+
+    top_ = kept > rows_ ? kept - rows_ : 0; 								// 5)
+    num_lines_ = kept > rows_ ? kept : rows_;
+    view_offset_ = 0;
+    cursor_row_ = kept - 1 - top_;
+    cursor_column_ = column;
+    pending_scroll_ = 0;
 }
 
 /*
- * 터미널에서 개행문자 '\n'(줄바꿈)을 구현하는 함수이다.
+ * 링 버퍼에 저장된 줄들을 새 열 수(columns_)에 맞게 다시 줄바꿈하는 함수이다.
+ * lock_을 가진 채(인터럽트 금지) 호출되므로 힙을 쓰지 않고, 링 버퍼 안에서 자리를 옮겨가며 처리한다.
  *
  * 동작방식:
- * 	1) cursor_column_을 0으로 초기화한다.(터미널에서 한 라인의 맨 처음에서 시작하기 위함)	 
+ * 	1) 이전 크기(old_rows, old_columns)를 기준으로 가장 오래된 줄과, 그 줄부터 커서가 있는 줄까지의 
+ * 	   줄 수를 구한다. 가장 오래된 줄이 0번이 되도록 링 버퍼를 회전시킨다.
+ *
+ * 	2) 커서가 있는 줄부터 거꾸로, 각 줄의 글자를 버퍼의 끝쪽으로 빈틈없이 모아 하나의 글자열을 만든다.
+ * 	   끝난 줄은 뒤쪽의 빈 칸을 지우고 마지막 글자에 kLineEnd를 표시한다. (빈 줄은 '\n' 한 칸)
+ * 	   두 칸 글자의 오른쪽 칸(kWideTail)은 다시 만들므로 모으지 않는다.
+ * 	   한 줄에서 모이는 글자는 그 줄의 칸 수보다 많지 않으므로, 아직 읽지 않은 줄을 덮어쓰지 않는다.
+ *
+ * 	3) 글자열을 새 열 수로 줄바꿈했을 때의 줄 수를 센다. 한 줄의 칸 수가 바뀌므로 링 버퍼에 들어가는
+ * 	   줄 수(history_lines_)도 다시 구하고, 그보다 많다면 가장 오래된 줄부터 버린다.
+ *
+ * 	4) 한 줄씩 reflow_row_에 배치한 뒤 새 열 수 간격으로 버퍼의 앞쪽부터 복사한다. 새 줄 하나에 들어가는 글자도
+ * 	   한 줄의 칸 수보다 많지 않으므로, 복사할 때 아직 읽지 않은 글자열은 항상 그 줄보다 뒤에 있다.
+ * 	   남은 줄은 빈 칸으로 지운다.
  *
- * 	2) cursor_row_의 값이 터미널의 가로길이의 -1보다 작다면, cursor_row_를 증가시킨다.
+ * 	5) 마지막 줄(커서가 있는 줄)이 화면의 아래쪽에 오도록 top_과 커서를 정한다.
  *
- * 	3) 터미널의 배경을 초기화하는 과정이다. 폰트의 폭과 높이인 8과 16을 각각 tVertical, tHorizontal에
- * 	   곱한 만큼의 이중 for문을 사용해서 터미널의 배경을 bg_color_로 초기화한다.
+ */
+
+
+
+bool Terminal::fillRow(const char32_t*& next, const char32_t* end, int& column, bool& wrapped) {
+    std::fill_n(reflow_row_, kMaxColumns, U' ');
+    column = 0;
+    wrapped = false;
+
+    while (next != end) {
+        const char32_t cell = *next;
+        if (cell == U'\n') {
+            ++next;
+            return true;
+        }
+
+        char32_t c = cell & ~kLineEnd;
+        int cells = glyphs_.Cells(c);
+        if (cells > columns_) {
+            c = '?';
+            cells = 1;
+        }
+        if (column > 0 && column + cells > columns_) {
+            wrapped = true;
+            return true;
+        }
+        reflow_row_[column] = c;
+        if (cells == 2) {
+            reflow_row_[column + 1] = GlyphCache::kWideTail;
+        }
+        column += cells;
+        ++next;
+        if (cell & kLineEnd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * reflow()가 모은 글자열에서 새 열 수에 맞는 한 줄을 꺼내 reflow_row_에 배치하는 함수이다.
+ * put()과 같은 규칙으로 줄을 바꾸며, 다음 줄이 이어진다면 true를 반환한다.
+ * 글자열이 끝났다면 그 줄이 커서가 있는 줄이므로 false를 반환한다.
+ *
+ */
+
+
+
+void Terminal::SetDeferred(bool deferred) {
+    IRQSaveLockGuard guard{lock_};
+    deferred_ = deferred;
+    if (!deferred_) {
+        render();
+        writer_->Flush();
+    }
+}
+
+void Terminal::Flush() {
+    IRQSaveLockGuard guard{lock_};
+    render();
+}
+
+/*
+ * 메인 루프가 돌기 시작하면 SetDeferred(true)로 그리기를 미루고,
+ * 메인 루프가 잠들기 직전에 Flush()로 그 사이의 출력을 한 번에 그린다.
+ * Flush()는 writer_에 그리기만 하므로, 화면 반영은 이어서 BackBuffer::Flush()가 한다.
+ *
+ * 부팅 초기(메인 루프 전)에는 멈추기 직전의 메시지도 바로 보여야 하므로 미루지 않는다.
+ *
+ */
+
+
+
+void Terminal::ScrollView(int lines) {
+    IRQSaveLockGuard guard{lock_};
+
+    const int max_offset = num_lines_ - rows_;
+    int offset = view_offset_ + lines;
+    offset = offset < 0 ? 0 : (offset > max_offset ? max_offset : offset);
+    if (offset == view_offset_) {
+        return;
+    }
+
+    view_offset_ = offset;
+    full_redraw_ = true;
+    if (!deferred_) {
+        render();
+        writer_->Flush();
+    }
+}
+
+/*
+ * 링 버퍼에 남아있는 줄(num_lines_) 범위 안에서 보이는 위치를 옮긴다.
+ * 보이는 줄이 모두 바뀌므로 화면 전체를 다시 그린다.
  *
- * 	4) 이중 for문이 실행되는 동안 터미널의 색상을 bg_color_로 초기화한다.
+ */
+
+
+
+
+void Terminal::newLine() {
+    cursor_column_ = 0; 											// 1)
+    if (cursor_row_ < rows_ - 1) { 										// 2)
+        ++cursor_row_;
+        return;
+    }
+
+    top_ = (top_ + 1) % history_lines_; 									// 3)
+    if (num_lines_ < history_lines_) {
+        ++num_lines_;
+    }
+    clearLine(lineAt(rows_ - 1)); 									// 4)
+    wrapped_[indexOf(rows_ - 1)] = false;
+
+    ++pending_scroll_; 												// 5)
+    for (int row = 0; row < rows_ - 1; ++row) {
+        dirty_begin_[row] = dirty_begin_[row + 1];
+        dirty_end_[row] = dirty_end_[row + 1];
+    }
+    dirty_begin_[rows_ - 1] = 0;
+    dirty_end_[rows_ - 1] = columns_;
+}
+
+/*
+ * 터미널에서 개행문자 '\n'(줄바꿈)을 구현하는 함수이다.
+ *
+ * 동작방식:
+ * 	1) cursor_column_을 0으로 초기화한다.(터미널에서 한 라인의 맨 처음에서 시작하기 위함)
  *
- * 	5) horizontal값이 tHorizontal-1의 값에 이를 때 까지를 범위로 하는 for문이다.
+ * 	2) cursor_row_의 값이 터미널의 행 수 -1보다 작다면, cursor_row_를 증가시킨다.
  *
- * 	6) 현재 행의 데이터를 다음 행으로 복사한다. -> 현재 버퍼의 모든 행을 한 칸씩 위로 이동시킨다.
- * 
- * 	7) print_str()함수를 사용해서 갱신된 버퍼 안의 데이터를 화면에 출력한다.
+ * 	3) 마지막 행에서 줄을 바꾸면 top_을 한 줄 옮겨 스크롤한다. 버퍼의 내용은 옮기지 않는다.
  *
- * 	8) memset(메모리 초기화 함수)로 마지막 행의 버퍼를 초기화한다. 
+ * 	4) 새로 화면에 들어온 줄(링 버퍼에서 가장 오래된 줄)을 빈 칸으로 지운다.
+ *
+ * 	5) 스크롤된 줄 수를 기록하고, 행마다 기록한 dirty 범위도 한 행씩 위로 옮긴다.
+ * 	   새 마지막 행은 전체를 다시 그려야 한다.
  *
  * PLUS:
- * 	과정 6)에서 버퍼의 모든 행을 한 칸씩 위로 이동시킨 이유 :
- * 		 이는 터미널의 스크롤 기능을 구현하기 위한 것으로, 터미널의 크기는 한정되어 있기에,
- * 		 새로운 줄이 추가되면 화면을 스크롤 하여 새로운 줄을 추가하기 위한 공간을 확보한다.
+ * 	링 버퍼를 사용하는 이유 :
+ * 		 2차원 배열을 memmove로 한 행씩 당기면 스크롤마다 화면 전체의 글자를 옮겨야 하고,
+ * 		 화면에서 사라진 줄은 버려진다. 링 버퍼는 인덱스만 바꾸므로 스크롤 비용이 일정하고,
+ * 		 지나간 줄을 스크롤백으로 보관할 수 있다.
  */
 
+
+
+void Terminal::markAllDirty() {
+    std::fill(dirty_begin_.begin(), dirty_begin_.begin() + rows_, 0);
+    std::fill(dirty_end_.begin(), dirty_end_.begin() + rows_, columns_);
+}
+
+void Terminal::render() {
+    const int width = kGlyphWidth * columns_, height = kGlyphHeight * rows_;
+
+    if (full_redraw_ || pending_scroll_ >= rows_) { 							// 1)
+        markAllDirty();
+    } else if (pending_scroll_ > 0) { 									// 2)
+        const int shift = kGlyphHeight * pending_scroll_;
+        writer_->MoveRect(area_.pos, {{area_.pos.x, area_.pos.y + shift}, {width, height - shift}});
+    }
+    pending_scroll_ = 0;
+    full_redraw_ = false;
+
+    for (int row = 0; row < rows_; ++row) { 								// 3)
+        const char32_t* line = lineAt(row);
+        int begin = dirty_begin_[row], end = dirty_end_[row];
+        if (begin < end) {
+            if (begin > 0 && line[begin] == GlyphCache::kWideTail) {
+                --begin;
+            }
+            if (end < columns_ && line[end] == GlyphCache::kWideTail) {
+                ++end;
+            }
+            glyphs_.WriteCells(
+                *writer_, area_.pos.x + kGlyphWidth * begin, area_.pos.y + kGlyphHeight * row,
+                line + begin, end - begin
+            );
+        }
+        dirty_begin_[row] = kMaxColumns;
+        dirty_end_[row] = 0;
+    }
+}
+
+/*
+ * 링 버퍼의 변경 사항을 화면에 그리는 함수이다.
+ *
+ * 동작방식:
+ * 	1) 스크롤백 이동 등으로 화면 전체가 바뀌었거나, 한 화면 이상 스크롤되었다면 모든 행을 다시 그린다.
+ *
+ * 	2) 그 외에 스크롤이 있었다면, 그 사이에 몇 줄이 스크롤되었든 MoveRect() 한 번으로 픽셀을 옮긴다.
+ * 	   새로 드러난 아래쪽 행들은 newLine()이 이미 dirty로 기록해두었다.
+ *
+ * 	3) 행마다 dirty 범위의 글자만 글리프 캐시의 WriteCells()로 그린다. 범위의 양 끝이 두 칸 글자의
+ * 	   가운데라면 글자 전체가 그려지도록 범위를 한 칸 넓힌다.
+ * 	   빈 칸은 ' ' 글리프이므로 배경을 따로 지울 필요가 없다.
+ *
+ */
@@ -1,24 +1,101 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include "../graphics/graphics.hpp"
+#include "../font/font.hpp"
+#include "../log/format.hpp"
+#include "../sync/spinlock.hpp"
 
-class Terminal {
+class Terminal : public OutputSink {
     public:
-        static const int tHorizontal = 25; 			 	                // 터미널의 가로 크기를 정의한다. 
-        static const int tVertical = 80; 			 	                // 터미널의 세로 크기를 정의한다. 
+        static const int kMaxRows = 128; 			 	                // 터미널의 최대 세로 크기(행 수)를 정의한다. (2048픽셀)
+        static const int kMaxColumns = 256; 			 	            // 터미널의 최대 가로 크기(열 수)를 정의한다. (2048픽셀)
+        static const int kHistoryLines = 2048; 		                    // 스크롤백을 포함하여 저장하는 최대 줄 수이다.
+        static const int kHistoryCells = 64 * 1024; 	                // 링 버퍼의 칸 수이다. 저장하는 줄 수는 열 수에 따라 정해진다. (256KiB)
+        static const int kGlyphWidth = GlyphCache::kGlyphWidth;
+        static const int kGlyphHeight = GlyphCache::kGlyphHeight;
 
-        Terminal( 							                            // forground_color, background_color를 인자로 받고
-            PixelWriter& writer, const PixelColor& fg_color,  	 	    // 터미널 영역의 픽셀을 초기화하는 생성자이다.
-            const PixelColor& bg_color
+        Terminal( 							                            // 터미널이 차지할 화면 영역과 forground_color, background_color를
+            NativePixelWriter& writer, const Rectangle<int>& area, 	    // 인자로 받고 터미널을 초기화하는 생성자이다.
+            const PixelColor& fg_color, const PixelColor& bg_color
         );
         void printString(const char* s); 				                // 터미널 안에서 한 라인에 맞추어 문자를 쓴다.
+        virtual void Write(const char* s, size_t length) override;      // 길이가 정해진 글자열을 쓴다. (OutputSink)
+        void SetWriter(NativePixelWriter& writer);                      // 터미널이 그릴 PixelWriter를 바꾼다. (예: BackBuffer)
+        void SetFont(const UnicodeFont* font);                          // 아스키가 아닌 글자를 그릴 유니코드 폰트를 정한다.
+        void Resize(const Rectangle<int>& area);                        // 터미널을 area(픽셀 좌표)에 맞는 크기로 바꾸고 내용을 다시 줄바꿈한다.
 
-    private: 
+        void SetDeferred(bool deferred);                                // true라면 printString()은 그리지 않고, Flush()에서 한 번에 그린다.
+        void Flush();                                                   // 지금까지 바뀐 글자를 writer에 그린다.
+        void ScrollView(int lines);                                     // 화면을 lines만큼 과거(+) 또는 최근(-) 방향으로 스크롤한다.
+
+        int Rows() const {  return rows_;  }
+        int Columns() const {  return columns_;  }
+
+    private:
+        static const char32_t kLineEnd = 0x80000000u; 		            // reflow() 중에 줄이 끝나는 글자에 표시하는 비트이다.
+
+        void put(char32_t c); 						                    // 글자 하나를 링 버퍼에 쓴다. (그리지 않는다)
         void newLine(); 						                        // 줄 바꿈을 구현하는 함수이다.
+        void reflow(int old_rows, int old_columns); 			                // 저장된 줄들을 현재 columns_에 맞게 다시 줄바꿈한다.
+        bool fillRow(const char32_t*& next, const char32_t* end,        // reflow()가 모은 글자열에서 한 줄을 reflow_row_에 배치한다.
+                     int& column, bool& wrapped);
+        void render(); 						                            // 바뀐 행과 스크롤을 화면에 반영한다. (lock_을 가진 상태에서 호출)
 
-        PixelWriter& writer_; 						                    // pixelwriter 객체를 참조한다.
+        int indexOf(int row) const {                                    // 화면의 row번째 행에 보이는 줄의 링 버퍼 인덱스
+            return (top_ - view_offset_ + row + history_lines_) % history_lines_;
+        }
+        char32_t* lineAt(int row) {  return history_ + indexOf(row) * columns_;  }
+        void clearLine(char32_t* line) {  std::fill_n(line, columns_, U' ');  }
+        void markDirty(int row, int begin, int end) {
+            dirty_begin_[row] = begin < dirty_begin_[row] ? begin : dirty_begin_[row];
+            dirty_end_[row] = end > dirty_end_[row] ? end : dirty_end_[row];
+        }
+        void markAllDirty();
+
+        NativePixelWriter* writer_; 					                // pixelwriter 객체를 지시한다.
         const PixelColor fg_color_, bg_color_; 				            // PixelColor 형식으로 fg_color, bg_color를 정의한다.
-        char buffer_[tHorizontal][tVertical + 1]; 			            // 터미널에 출력할 문자열을 저장하는 2차원 버퍼를 정의한다.
+        Rectangle<int> area_; 						                    // 터미널이 차지하는 화면 영역(픽셀 좌표)이다.
+        int rows_, columns_; 						                    // 현재 터미널의 크기(행 수, 열 수)이다.
+
+        char32_t history_[kHistoryCells]; 			                    // 줄 단위 링 버퍼이다. 한 줄은 columns_칸이며, 칸마다 코드 포인트를 저장하고 빈 칸은 ' '로 채운다.
+        bool wrapped_[kHistoryLines]; 					                // 줄이 가득 차서 다음 줄로 이어지는지(자동 줄바꿈) 여부이다.
+        char32_t reflow_row_[kMaxColumns]; 				                // reflow()가 새 줄 하나를 배치하는 작업 공간이다.
+        int history_lines_; 					                        // 링 버퍼에 들어가는 줄 수이다. (kHistoryCells / columns_, 최대 kHistoryLines)
+
+        int top_; 						                                // 맨 아래까지 스크롤했을 때 화면 첫 행에 보이는 줄의 링 버퍼 인덱스이다.
+        int num_lines_; 						                        // 링 버퍼에 저장된 유효한 줄 수이다. (rows_ ~ history_lines_)
+        int view_offset_; 						                        // 스크롤백을 보고 있다면 맨 아래에서 위로 올라간 줄 수이다.
 
         int cursor_row_, cursor_column_; 				                // 현재 커서의 위치를 나타내는 변수를 정의한다.
+
+        std::array<int, kMaxRows> dirty_begin_, dirty_end_; 	        // 행마다 다시 그려야 하는 열 범위 [begin, end)이다.
+        int pending_scroll_; 						                    // 마지막으로 그린 뒤 스크롤된 줄 수이다.
+        bool full_redraw_; 						                        // 화면 전체를 다시 그려야 하는지 여부이다.
+        bool deferred_; 						                        // 그리기를 Flush()까지 미루는지 여부이다.
+
+        GlyphCache glyphs_; 						                    // fg_color_, bg_color_로 미리 그려둔 글리프 캐시이다.
+        Utf8Decoder decoder_; 						                    // Write()로 들어오는 바이트를 코드 포인트로 바꾼다.
+        TicketLock lock_;                                               // 여러 코어나 인터럽트에서 동시에 출력하지 않도록 보호한다.
 };
+
+/*
+ * 터미널의 글자는 링 버퍼(history_)에 줄 단위로 저장되며, 화면에는 마지막 rows_개의 줄이 보인다.
+ * 스크롤할 때 버퍼를 옮기지 않고 top_만 한 칸 이동하므로, 지나간 줄은 덮어쓰일 때까지
+ * 스크롤백으로 남는다.
+ *
+ * 터미널의 크기는 Resize()로 주어진 화면 영역에서 정해진다. (최대 kMaxColumns x kMaxRows)
+ * 링 버퍼의 한 줄은 실제 열 수(columns_)만큼의 칸이므로, 좁은 화면일수록 더 많은 줄을 스크롤백으로 남긴다.
+ * 열 수를 넘는 줄은 다음 줄로 이어지며(wrapped_), 크기가 바뀌면 이어진 줄들을 하나의 
+ * 논리적인 줄로 보고 새 열 수에 맞게 다시 줄바꿈(reflow)한다.
+ *
+ * Write()는 UTF-8로 디코딩한 코드 포인트를 칸에 저장한다. 한글처럼 폭이 16픽셀인 글리프는
+ * 두 칸을 차지하며, 오른쪽 칸에는 GlyphCache::kWideTail을 저장한다. 두 칸 글자는 줄의
+ * 끝에서 나뉘지 않고 다음 줄로 넘어간다.
+ *
+ * printString()은 버퍼만 바꾸고 바뀐 열 범위를 행마다 기록(dirty)한다. 실제로 그리는 것은
+ * render()이며, deferred_가 false라면 printString()이 끝날 때, true라면 Flush()가 호출될 때 그린다.
+ * 따라서 여러 번의 printk 출력과 스크롤은 한 번의 그리기로 합쳐진다.
+ *
+ * */
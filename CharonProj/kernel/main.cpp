@@ -8,6 +8,7 @@
     #include <cstdio>
     #include <cstdarg>
 
+    #include <algorithm>
     #include <numeric>
     #include <vector>
 
@@ -19,6 +20,11 @@
 
     // graphics
     #include "lib/graphics/graphics.hpp"
+    #include "lib/graphics/pixel_ops.hpp"
+    #include "lib/graphics/back_buffer.hpp"
+
+    // cpu
+    #include "lib/cpu/cpu.hpp"
 
     // frame buffer
     #include "lib/framebuffer/frame_buffer_config.hpp"
@@ -29,11 +35,15 @@
     // pci
     #include "lib/pci/pci.hpp"
 
+    // serial
+    #include "lib/serial/serial.hpp"
+
     // mouse
     #include "lib/mouse/mouse.hpp"
 
     // log
     #include "lib/log/logger.hpp"
+    #include "lib/log/format.hpp"
 
     // interrupt 
     #include "lib/interrupt/interrupt.hpp"
@@ -42,6 +52,9 @@
     // queue
     #include "lib/queue/queue.hpp"
 
+    // sync
+    #include "lib/sync/spinlock.hpp"
+
     // memory map
     #include "lib/memory/memory_map.hpp"
 
@@ -69,6 +82,7 @@
     #include "usb/memory.hpp"
     #include "usb/device.hpp"
     #include "usb/classdriver/mouse.hpp"
+    #include "usb/classdriver/keyboard.hpp"
     #include "usb/xhci/xhci.hpp"
     #include "usb/xhci/trb.hpp"
 
@@ -86,12 +100,23 @@ const PixelColor DesktopFGColor{255, 255, 255};
 
 
 //define pixel-write buffer
-char pixel_write_buf[sizeof(RGBResv8BitPerColorPixelWriter)];
-PixelWriter* pixel_writer;
+char pixel_write_buf[std::max({
+    sizeof(RGBResv8BitPerColorPixelWriter),
+    sizeof(BGRResv8BitPerColorPixelWriter),
+    sizeof(BitmaskPixelWriter)
+})];
+FrameBufferWriter* pixel_writer;
 /*  픽셀 작성자에 사용되는 버퍼의 크기와 픽셀 작성자 변수를 설정한다.  */
 
 
 
+//define back buffer
+char back_buffer_buf[sizeof(BackBuffer)];
+BackBuffer* back_buffer;
+/*  힙이 준비된 뒤 만들어지며, 이후 터미널과 마우스 커서는 프레임 버퍼 대신 여기에 그린다.  */
+
+
+
 //define Terminal-buf
 char terminal_buf[sizeof(Terminal)];
 Terminal* terminal;
@@ -103,23 +128,23 @@ Terminal* terminal;
 int printk(const char* format, ...) {
     va_list ap;
     int result;
-    char s[2048];
+    ConsoleSink console;
+    ChunkedSink<256> sink{console};
 
     va_start(ap, format);
-    result = vsprintf(s, format, ap);
+    result = VFormat(sink, format, ap);
     va_end(ap);
 
-    terminal->printString(s);
     return result;
 }
 
 /*
- * 터미널에서 숫자와 문자 출력 등을 지원하는 printk 함수이다. 
+ * 콘솔(터미널, 시리얼 포트)에 숫자와 문자 출력 등을 지원하는 printk 함수이다. 
  * %d등의 형식 지정자를 사용하여 사칙연산을 지원한다.
  *
- * 문자열을 저장할 버퍼는 2038크기로 되어 있으며, 
- * c++의 vsprintf()함수를 사용하여 형식화된 문자열을 printString()함수로 
- * 출력 가능한 형태로 변형한 뒤 터미널에 출력을 시작한다.
+ * 커널의 형식 변환기(VFormat)가 변환 결과를 256바이트 크기의 ChunkedSink에 조각으로 흘려보내고,
+ * ChunkedSink는 가득 찰 때마다 콘솔에 등록된 출력 대상들에 넘긴다. 문자열 전체를 담을 버퍼가 없으므로 
+ * 출력이 아무리 길어도 버퍼가 넘치지 않는다.
  *
  *
  * */
@@ -129,6 +154,10 @@ char memory_manager_buf[sizeof(BitmapMemoryManager)];
 BitmapMemoryManager* memory_manager;
 
 
+char unicode_font_buf[sizeof(UnicodeFont)];
+UnicodeFont* unicode_font;
+
+
 char mouse_cursor_buf[sizeof(MouseCursor)];
 MouseCursor* mouse_cursor;
 
@@ -136,6 +165,22 @@ void MouseObserver(int8_t displacement_x, int8_t displacement_y) {
     mouse_cursor->MoveRelative({displacement_x, displacement_y});
 }
 
+// F12 키를 누르면 인터럽트 통계를 터미널에 출력한다.
+// Page Up / Page Down 키로 터미널의 스크롤백을 반 화면씩 넘긴다.
+const uint8_t kKeyF12 = 0x45;
+const uint8_t kKeyPageUp = 0x4b;
+const uint8_t kKeyPageDown = 0x4e;
+
+void KeyboardObserver(uint8_t keycode) {
+    if (keycode == kKeyF12) {
+        DumpInterruptStats();
+    } else if (keycode == kKeyPageUp) {
+        terminal->ScrollView(terminal->Rows() / 2);
+    } else if (keycode == kKeyPageDown) {
+        terminal->ScrollView(-terminal->Rows() / 2);
+    }
+}
+
 void SwichEhci2Xhci(const pci::Device& xhc_dev) {
     bool intel_ehc_exist = false;
 
@@ -156,7 +201,7 @@ void SwichEhci2Xhci(const pci::Device& xhc_dev) {
     uint32_t ehci2xhci_ports = pci::ReadConfigReg(xhc_dev, 0xd4);
     pci::WriteConfigReg(xhc_dev, 0xd0, ehci2xhci_ports);
 
-    Log(kDebug, "SwichEhciXhci: SS = %02, xHCI = %02x\n", superspeed_ports, ehci2xhci_ports);
+    Log(kDebug, "SwichEhciXhci: SS = %02x, xHCI = %02x\n", superspeed_ports, ehci2xhci_ports);
 }
 
 
@@ -168,18 +213,48 @@ struct Message {
     enum Type {
         kInterruptXHCI,
     } type;
+
+    uint8_t vector;                 // 메세지를 보낸 인터럽트 벡터
+    uint64_t timestamp;             // ISR에 진입한 시각(TSC)
 };
 
 kQueue<Message>* main_queue;
+TicketLock main_queue_lock;
+uint8_t xhci_vector;
 
 __attribute__((interrupt))
 void IntHandlerXHCI(InterruptFrame* frame) {
-    main_queue->Push(Message{Message::kInterruptXHCI});
+    InterruptStatsScope stats{xhci_vector};
+    {
+        LockGuard guard{main_queue_lock};
+        main_queue->Push(Message{Message::kInterruptXHCI, xhci_vector, stats.Start()});
+    }
 
     NotifyEndOfInterrupt();
 }
 
 
+/*  serial console  */
+char serial_port_buf[sizeof(SerialPort)];
+SerialPort* serial_port;
+uint8_t serial_vector;
+
+__attribute__((interrupt))
+void IntHandlerSerial(InterruptFrame* frame) {
+    InterruptStatsScope stats{serial_vector};
+    serial_port->OnInterrupt();
+
+    NotifyEndOfInterrupt();
+}
+
+/*
+ * 송신 FIFO가 비었을 때 발생하는 COM1 인터럽트의 핸들러이다.
+ * 링 버퍼에서 FIFO로 최대 16바이트를 옮기는 짧은 작업이므로 main_queue를 거치지 않고 
+ * 핸들러 안에서 바로 처리한다.
+ *
+ */
+
+
 
 
 
@@ -206,6 +281,15 @@ extern "C" void KernelMainNewStack(
     const FrameBufferConfig& frame_buffer_config{frame_buffer_config_ref};
     const MemoryMap& memory_map{memory_map_ref};
 
+    InitializeCPUFeatures();
+    InitializePixelOps();
+
+    /*
+     * 가장 먼저 SSE/AVX 상태를 활성화하고, CPU 기능에 맞는 픽셀 함수(SSE2, AVX2)를 선택한다.
+     * 이후의 모든 화면 그리기는 선택된 구현을 사용한다.
+     *
+     */
+
     switch (frame_buffer_config.pixel_format) { 				    // 1)
         case kPixelRGBResv8BitPerColor: 					        // 2)
             pixel_writer = new(pixel_write_buf)
@@ -216,6 +300,21 @@ extern "C" void KernelMainNewStack(
             pixel_writer = new(pixel_write_buf)
             BGRResv8BitPerColorPixelWriter{frame_buffer_config};
         break;
+
+        case kPixelBitMask: {                                       // 4)
+            const auto& mask = frame_buffer_config.pixel_bitmask;
+            if (RGBResv8BitPerColorLayout::Matches(mask)) {
+                pixel_writer = new(pixel_write_buf)
+                RGBResv8BitPerColorPixelWriter{frame_buffer_config};
+            } else if (BGRResv8BitPerColorLayout::Matches(mask)) {
+                pixel_writer = new(pixel_write_buf)
+                BGRResv8BitPerColorPixelWriter{frame_buffer_config};
+            } else {
+                pixel_writer = new(pixel_write_buf)
+                BitmaskPixelWriter{frame_buffer_config, DynamicPixelLayout{mask}};
+            }
+        }
+        break;
     }
 
     /*
@@ -230,6 +329,9 @@ extern "C" void KernelMainNewStack(
      *
      *     3) 만약 픽셀 형식이 BGR 형식이라면 BGR 형식을 따르는 픽셀 작성자를 선택한다. 
      *
+     *     4) 만약 픽셀 형식이 비트 마스크 형식이라면, 마스크가 RGB, BGR 형식과 같을 때는 
+     *        컴파일 시간에 특수화된 픽셀 작성자를, 그렇지 않다면 마스크를 따르는 픽셀 작성자를 선택한다.
+     *
      */
 
     
@@ -238,6 +340,13 @@ extern "C" void KernelMainNewStack(
     const int kFrameHeight = frame_buffer_config.vertical_resolution;
     /*  frame_buffer_config 헤더파일에 정의되어 있는 화면 비율 설정을 커널의 프레임 길이로 정의한다.  */
 
+    const int kTaskbarHeight = 50;
+    const int kShapeBandHeight = 100;
+    /*  
+     *  작업 표시줄 바로 위의 kShapeBandHeight 높이의 띠에는 아래의 도형들을 그린다. 
+     *  터미널은 이 띠의 위쪽만 차지하므로, 글자나 스크롤이 도형을 덮어쓰거나 끌고 가지 않는다.
+     */
+
 
 
     
@@ -276,7 +385,7 @@ extern "C" void KernelMainNewStack(
     );
     paintEllipse(
         *pixel_writer,
-        {200, kFrameHeight - 300},
+        {200, kFrameHeight - kTaskbarHeight - kShapeBandHeight / 2},
         60, 30,
         Magenta
     );
@@ -294,13 +403,13 @@ extern "C" void KernelMainNewStack(
     );
     paintCircle(
         *pixel_writer,
-        {kFrameWidth-500, kFrameHeight-500},
+        {kFrameWidth-500, kFrameHeight - kTaskbarHeight - kShapeBandHeight / 2},
         15,
         Green
     );
     paintCircle(
         *pixel_writer,
-        {kFrameWidth-800, kFrameHeight-500},
+        {kFrameWidth-800, kFrameHeight - kTaskbarHeight - kShapeBandHeight / 2},
         15,
         Blue
     );
@@ -309,11 +418,29 @@ extern "C" void KernelMainNewStack(
 
 
 
+    //enable serial console
+    serial_port = new(serial_port_buf) SerialPort{SerialPort::kCOM1};
+    if (!serial_port->Initialize(115200)) {
+        AddConsoleSink(serial_port);
+    }
+    /*
+     * 화면보다 먼저 COM1을 콘솔에 등록하여, 터미널이 동작하지 않거나 화면이 없는 환경
+     * (QEMU -nographic 등)에서도 부팅 로그를 시리얼로 받을 수 있게 한다.
+     * 인터럽트를 설정하기 전까지는 polling으로 보낸다.
+     */
+
+
+
     //enter terminal envirorment
     terminal = new(terminal_buf) Terminal(
-        *pixel_writer, DesktopFGColor, DesktopBGColor
+        *pixel_writer, {{0, 0}, {kFrameWidth, kFrameHeight - kTaskbarHeight - kShapeBandHeight}},
+        DesktopFGColor, DesktopBGColor
     );
-    /*  fg_color, bg_color, writer를 인수로 갖는 터미널 변수를 새로 설정한다.  */
+    /*  
+     *  fg_color, bg_color, writer를 인수로 갖는 터미널 변수를 새로 설정한다.  
+     *  터미널은 작업 표시줄과 도형을 그린 띠를 제외한 바탕화면을 차지하며, 행과 열의 수는 해상도에 따라 정해진다.
+     */
+    AddConsoleSink(terminal);
 
 
 
@@ -321,6 +448,11 @@ extern "C" void KernelMainNewStack(
     printk("CharonOS v0.0.7\n"); 		/*  현재 커널의 버전을 표시한다.  */
     SetLogLevel(kWarn);
 
+    const auto& cpu_features = GetCPUFeatures();
+    Log(kInfo, "CPU: sse2=%d sse4.1=%d avx=%d avx2=%d erms=%d xsave_size=%u\n",
+        cpu_features.sse2, cpu_features.sse41, cpu_features.avx,
+        cpu_features.avx2, cpu_features.erms, cpu_features.xsave_size);
+
 
 
     SetupSegments();
@@ -372,13 +504,38 @@ extern "C" void KernelMainNewStack(
             "failed to allocate pages: %s at %s:%d\n",
             err.Name(), err.File(), err.Line()
         );
+        DrainLog();
         exit(1);
     }
 
 
+    //switch to back buffer
+    back_buffer = new(back_buffer_buf) BackBuffer{*pixel_writer};
+    terminal->SetWriter(*back_buffer);
+
+    //load unicode font
+    unicode_font = new(unicode_font_buf) UnicodeFont;
+    if (auto err = LoadBuiltinUnicodeFont(*unicode_font)) {
+        Log(err.Cause() == Error::kEmpty ? kInfo : kError,
+            "unicode font is not available: %s at %s:%d\n", err.Name(), err.File(), err.Line());
+    } else {
+        terminal->SetFont(unicode_font);
+    }
+    /*
+     * 아틀라스의 해시 테이블은 힙에 만들어지므로 InitializeHeap() 이후에 불러온다.
+     * 아틀라스가 링크되지 않았다면 터미널은 아스키 글자만 그리고, 나머지는 '?'로 표시한다.
+     */
+
+    /*
+     * 힙을 사용할 수 있게 되었으므로 화면 크기의 back buffer를 만든다. 
+     * 이후 터미널과 마우스 커서는 back buffer에 그리고, Flush()로 변경된 영역만 프레임 버퍼에 복사한다.
+     *
+     */
+
+
     //render mouse cursor
     mouse_cursor = new(mouse_cursor_buf) MouseCursor {
-        pixel_writer, DesktopBGColor, {300, 200}
+        back_buffer, {300, 200}
     };
 
     std::array<Message, 32> main_queue_data;
@@ -395,7 +552,8 @@ extern "C" void KernelMainNewStack(
 
         Log(kDebug, "%d.%d.%d: vend %04x, class %08x, head %02x\n",
                 dev.bus, dev.device, dev.function,
-                vendor_id, class_code, dev.header_type);
+                vendor_id, (class_code.base << 24) | (class_code.sub << 16) | (class_code.interface << 8),
+                dev.header_type);
     }
 
     // find xhc
@@ -415,21 +573,41 @@ extern "C" void KernelMainNewStack(
     }
 
 
-    SetIDTEntry(idt[InterruptVector::kXHCI], MakeIDTAttr(DescriptorType::kInterruptGate, 0),
-                reinterpret_cast<uint64_t>(IntHandlerXHCI), kernel_cs);
-
     LoadIDT(sizeof(idt) - 1, reinterpret_cast<uintptr_t>(&idt[0]));
+    /*
+     * MSI와 IOAPIC 엔트리를 켜기 전에 IDT를 읽어들인다. 이후 RegisterMSIHandler() 등이 
+     * idt[]에 쓰는 엔트리는 같은 테이블이므로 다시 읽어들이지 않아도 바로 반영된다.
+     */
 
+    const uint8_t bsp_local_apic_id = GetLocalAPICID();
+
+    if (auto [vector, err] = RegisterMSIHandler(
+            *xhc_dev, IntHandlerXHCI,
+            InterruptPriority::kNormal, bsp_local_apic_id
+        ); err) {
+        Log(kError, "failed to register xHCI interrupt: %s at %s:%d\n",
+                err.Name(), err.File(), err.Line());
+    } else {
+        xhci_vector = vector;
+        Log(kDebug, "xHCI interrupt vector = %02x\n", xhci_vector);
+    }
 
-    const uint8_t bsp_local_apic_id = 
-        *reinterpret_cast<const uint32_t*>(0xfee00020) >> 24;
-    
-    pci::ConfigureMSIFixedDestination(
-        *xhc_dev, bsp_local_apic_id,
-        pci::MSITriggerMode::kLevel, 
-        pci::MSIDeliveryMode::kFixed,
-        InterruptVector::kXHCI, 0
-    );
+    if (serial_port->Present()) {
+        if (auto [vector, err] = RegisterISAHandler(
+                SerialPort::kCOM1IRQ, IntHandlerSerial,
+                InterruptPriority::kLow, bsp_local_apic_id
+            ); err) {
+            Log(kError, "failed to register serial interrupt: %s at %s:%d\n",
+                    err.Name(), err.File(), err.Line());
+        } else {
+            serial_vector = vector;
+            Log(kDebug, "serial interrupt vector = %02x\n", serial_vector);
+        }
+    }
+
+    if (serial_vector != 0) {
+        serial_port->EnableTxInterrupt();
+    }
 
 
 
@@ -442,6 +620,17 @@ extern "C" void KernelMainNewStack(
     /*  init xhc  */
     usb::xhci::Controller xhc{xhc_mmio_base};
 
+    {
+        auto moderation = usb::xhci::kDefaultInterruptModeration;
+        moderation.mode = usb::xhci::InterruptModeration::kAdaptive;
+        xhc.SetInterruptModeration(moderation);
+    }
+    /*
+     * 1000Hz 마우스처럼 보고서를 자주 보내는 HID 장치가 보고서마다 MSI를 발생시키지 않도록
+     * 프라이머리 인터럽터의 interrupt moderation을 적응형으로 설정한다.
+     * 여기서는 설정값을 저장만 하고, 컨트롤러를 리셋한 뒤 xhc.Initialize()가 인터럽터를 설정하면서 IMOD 레지스터에 기록한다.
+     */
+
 
     if (0x8086 == pci::ReadVendorId(*xhc_dev)) {
         SwichEhci2Xhci(*xhc_dev);
@@ -461,6 +650,7 @@ extern "C" void KernelMainNewStack(
 
     /*  configure port  */
     usb::HIDMouseDriver::default_observer = MouseObserver;
+    usb::HIDKeyboardDriver::default_observer = KeyboardObserver;
 
     for (int i = 1; i <= xhc.MaxPorts(); ++i) {
         auto port = xhc.PortAt(i);
@@ -476,27 +666,59 @@ extern "C" void KernelMainNewStack(
         }
     } 
 
+    StartLogDrain();
+    terminal->SetDeferred(true);
+
     while(1) {
         __asm__("cli");
+        main_queue_lock.Lock();
 
         if (main_queue.Count() == 0) {
-            __asm__("sti\n\thlt");
+            main_queue_lock.Unlock();
+            __asm__("sti");
+
+            DrainLog();
+            serial_port->Poll();
+            terminal->Flush();
+            back_buffer->Flush();
+
+            __asm__("cli");
+            if (main_queue.Count() == 0) {
+                __asm__("sti\n\thlt");
+            } else {
+                __asm__("sti");
+            }
             continue;
         }
 
         Message msg = main_queue.Front();
         main_queue.Pop();
+        main_queue_lock.Unlock();
         __asm__("sti");
+        /*
+         * 큐를 모두 처리한 뒤 잠들기 직전에 한 번만 Flush()하므로, 그 사이에 들어온 
+         * 여러 마우스 이동과 터미널 출력은 각각 한 번의 그리기로 합쳐진다.
+         *
+         * sti 직후의 hlt는 인터럽트로 중단되지 않으므로, 큐가 비어있는지 확인한 뒤 
+         * 잠드는 사이에 도착한 인터럽트를 놓치지 않기 위해 IRQSaveLockGuard 대신 
+         * cli / sti를 직접 사용한다. 락은 다른 코어의 ISR과의 경쟁을 막는다.
+         */
+
+        RecordQueueLatency(msg.vector, msg.timestamp);
 
         switch (msg.type) {
-            case Message::kInterruptXHCI:
+            case Message::kInterruptXHCI: {
+                unsigned int num_events = 0;
                 while (xhc.PrimaryEventRing() -> HasFront()) {
                     if (auto err = ProcessEvent(xhc)) {
                         Log(kError, "Error while ProcessEvent: %s at %s:%d\n",
                                 err.Name(), err.File(), err.Line());
                     }
+                    ++num_events;
                 }
+                xhc.OnEventRingDrained(num_events);
                 break;
+            }
             default:
                 Log(kError, "Unkown message type: %d\n", msg.type);
         }
@@ -83,7 +83,7 @@ namespace {
   void Log(LogLevel level, const usb::EndpointConfig& conf) {
     Log(level, "EndpointConf: ep_id=%d, ep_type=%d"
         ", max_packet_size=%d, interval=%d\n",
-        conf.ep_id.Address(), conf.ep_type,
+        conf.ep_id.Address(), static_cast<int>(conf.ep_type),
         conf.max_packet_size, conf.interval);
   }
 
@@ -148,7 +148,7 @@ namespace usb {
 
   Error Device::OnControlCompleted(EndpointID ep_id, SetupData setup_data,
                                    const void* buf, int len) {
-    Log(kDebug, "Device::OnControlCompleted: buf 0x%08x, len %d, dir %d\n",
+    Log(kDebug, "Device::OnControlCompleted: buf %p, len %d, dir %d\n",
         buf, len, setup_data.request_type.bits.direction);
     if (is_initialized_) {
       if (auto w = event_waiters_.Get(setup_data)) {
@@ -110,7 +110,7 @@ namespace usb::xhci {
       return err;
     }
 
-    Log(kDebug, "Device::ControlIn: ep addr %d, buf 0x%08x, len %d\n",
+    Log(kDebug, "Device::ControlIn: ep addr %d, buf %p, len %d\n",
         ep_id.Address(), buf, len);
     if (ep_id.Number() < 0 || 15 < ep_id.Number()) {
       return MAKE_ERROR(Error::kInvalidEndpointNumber);
@@ -157,7 +157,7 @@ namespace usb::xhci {
       return err;
     }
 
-    Log(kDebug, "Device::ControlOut: ep addr %d, buf 0x%08x, len %d\n",
+    Log(kDebug, "Device::ControlOut: ep addr %d, buf %p, len %d\n",
         ep_id.Address(), buf, len);
     if (ep_id.Number() < 0 || 15 < ep_id.Number()) {
       return MAKE_ERROR(Error::kInvalidEndpointNumber);
@@ -227,7 +227,7 @@ namespace usb::xhci {
       return err;
     }
 
-    Log(kDebug, "Device::InterrutpOut: ep addr %d, buf %08lx, len %d, dev %08lx\n",
+    Log(kDebug, "Device::InterrutpOut: ep addr %d, buf %p, len %d, dev %p\n",
         ep_id.Address(), buf, len, this);
     return MAKE_ERROR(Error::kNotImplemented);
   }
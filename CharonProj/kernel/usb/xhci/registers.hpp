@@ -272,6 +272,14 @@ namespace usb::xhci {
 
   using PortRegisterSetArray = ArrayWrapper<PortRegisterSet>;
 
+  union MFINDEX_Bitmap {
+    uint32_t data[1];
+    struct {
+      uint32_t microframe_index : 14;
+      uint32_t : 18;
+    } __attribute__((packed)) bits;
+  } __attribute__((packed));
+
   union IMAN_Bitmap {
     uint32_t data[1];
     struct {
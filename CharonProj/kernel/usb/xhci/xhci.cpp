@@ -1,5 +1,7 @@
 #include "usb/xhci/xhci.hpp"
 
+#include <algorithm>
+
 #include "logger.hpp"
 #include "usb/setupdata.hpp"
 #include "usb/device.hpp"
@@ -383,6 +385,10 @@ namespace usb::xhci {
         return err;
     }
 
+    // イベントリングを登録したインタラプタにだけ IMOD を書き込む．
+    interrupter_ready_ = true;
+    WriteInterruptModeration();
+
     // Enable interrupt for the primary interrupter
     auto iman = primary_interrupter->IMAN.Read();
     iman.bits.interrupt_pending = true;
@@ -409,6 +415,65 @@ namespace usb::xhci {
     return MAKE_ERROR(Error::kSuccess);
   }
 
+  void Controller::SetInterruptModeration(const InterruptModeration& moderation) {
+    moderation_ = moderation;
+    if (moderation_.min_interval > moderation_.max_interval) {
+      moderation_.max_interval = moderation_.min_interval;
+    }
+    moderation_.interval = std::clamp(
+        moderation_.interval, moderation_.min_interval, moderation_.max_interval);
+    interrupt_gap_x16_ = moderation_.interval * 16u;
+    last_mfindex_valid_ = false;
+    if (interrupter_ready_) {
+      WriteInterruptModeration();
+    }
+  }
+
+  void Controller::WriteInterruptModeration() {
+    auto interrupter = &InterrupterRegisterSets()[0];
+    auto imod = interrupter->IMOD.Read();
+    imod.bits.interrupt_moderation_interval = moderation_.interval;
+    imod.bits.interrupt_moderation_counter = 0;
+    interrupter->IMOD.Write(imod);
+  }
+
+  void Controller::OnEventRingDrained(unsigned int num_events) {
+    if (moderation_.mode != InterruptModeration::kAdaptive) {
+      return;
+    }
+
+    // MFINDEX は 125us（IMODI の 500 単位）で 1 進む 14 ビットのカウンタ．
+    // 2 秒ほどで一周するが，それ以上空いた割り込みは「少ない」と分かれば十分．
+    const uint32_t kUnitsPerMicroframe = 500;
+    const uint16_t mfindex = MicroframeIndex()->Read().bits.microframe_index;
+    if (!last_mfindex_valid_) {
+      last_mfindex_ = mfindex;
+      last_mfindex_valid_ = true;
+      return;
+    }
+    const uint32_t gap = ((mfindex - last_mfindex_) & 0x3fffu) * kUnitsPerMicroframe;
+    last_mfindex_ = mfindex;
+
+    // avg = avg * 7/8 + gap * 1/8
+    interrupt_gap_x16_ = (interrupt_gap_x16_ * 7 + gap * 16) / 8;
+
+    // 1) 間隔が interval の 1.25 倍以下なら，IMOD が割り込みを抑えている（頭打ち）．
+    // 2) 間隔が interval の 2 倍を超えるなら，IMOD は何もまとめておらず遅延を足すだけ．
+    const uint32_t interval_x16 = moderation_.interval * 16u;
+    uint16_t interval = moderation_.interval;
+    if (num_events > 0 && interrupt_gap_x16_ <= interval_x16 + interval_x16 / 4) {
+      interval = std::min<unsigned int>(interval * 2u, moderation_.max_interval);
+    } else if (interrupt_gap_x16_ > interval_x16 * 2) {
+      interval = std::max<unsigned int>(interval / 2u, moderation_.min_interval);
+    }
+
+    if (interval != moderation_.interval) {
+      moderation_.interval = interval;
+      WriteInterruptModeration();
+      Log(kDebug, "xHC IMOD interval = %u\n", interval);
+    }
+  }
+
   DoorbellRegister* Controller::DoorbellRegisterAt(uint8_t index) {
     return &DoorbellRegisters()[index];
   }
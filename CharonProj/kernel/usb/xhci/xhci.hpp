@@ -14,6 +14,28 @@
 #include "usb/xhci/devmgr.hpp"
 
 namespace usb::xhci {
+  /** @brief プライマリインタラプタの割り込みモデレーション設定．
+   *
+   * interval は IMOD レジスタの IMODI と同じ 250ns 単位．
+   * kAdaptive では割り込みの到着間隔を見ながら
+   * [min_interval, max_interval] の範囲で interval を自動調整する．
+   */
+  struct InterruptModeration {
+    enum Mode {
+      kFixed,
+      kAdaptive,
+    } mode;
+
+    uint16_t interval;
+    uint16_t min_interval;
+    uint16_t max_interval;
+  };
+
+  /** 40us 間隔（Linux の xHCI ドライバと同じ既定値）．上限は 1ms． */
+  const InterruptModeration kDefaultInterruptModeration{
+    InterruptModeration::kFixed, 160, 160, 4000
+  };
+
   class Controller {
    public:
     Controller(uintptr_t mmio_base);
@@ -28,6 +50,24 @@ namespace usb::xhci {
     uint8_t MaxPorts() const { return max_ports_; }
     DeviceManager* DeviceManager() { return &devmgr_; }
 
+    /** @brief 割り込みモデレーションの設定を変更する．
+     *
+     * Initialize() より前に呼んだ場合は値を保存するだけで，リセット前のコントローラには
+     * 書き込まない．IMOD レジスタへは Initialize() がインタラプタを設定した後に反映する．
+     */
+    void SetInterruptModeration(const InterruptModeration& moderation);
+    const InterruptModeration& GetInterruptModeration() const { return moderation_; }
+
+    /** @brief 1 回の割り込みで処理したイベント数を通知する．
+     *
+     * kAdaptive のときは，MFINDEX で測った割り込み間隔の移動平均を見る．
+     * 割り込みが interval の許す限りの頻度で来ている（間隔が interval 程度しかない）
+     * ときだけ interval を倍にし，間隔が interval の 2 倍を超える（割り込みが少ない）
+     * ときは min_interval に向けて半分にする．割り込みが少ないときに interval を
+     * 伸ばしても割り込みは減らず，遅延が増えるだけなので伸ばさない．
+     */
+    void OnEventRingDrained(unsigned int num_events);
+
    private:
     static const size_t kDeviceSize = 8;
 
@@ -40,6 +80,19 @@ namespace usb::xhci {
     Ring cr_;
     EventRing er_;
 
+    InterruptModeration moderation_{kDefaultInterruptModeration};
+    uint32_t interrupt_gap_x16_{0};  // 割り込み間隔の移動平均（250ns 単位を 16 倍した固定小数点）
+    uint16_t last_mfindex_{0};
+    bool last_mfindex_valid_{false};
+    bool interrupter_ready_{false};  // Initialize() がプライマリインタラプタを設定し終えたか
+
+    void WriteInterruptModeration();
+
+    MemMapRegister<MFINDEX_Bitmap>* MicroframeIndex() const {
+      return reinterpret_cast<MemMapRegister<MFINDEX_Bitmap>*>(
+          mmio_base_ + cap_->RTSOFF.Read().Offset());
+    }
+
     InterrupterRegisterSetArray InterrupterRegisterSets() const {
       return {mmio_base_ + cap_->RTSOFF.Read().Offset() + 0x20u, 1024};
     }
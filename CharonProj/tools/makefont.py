@@ -4,10 +4,23 @@ import argparse
 import collections
 import functools
 import re
+import struct
 import sys
 
 
 BITMAP_PATTERN = re.compile(r'([.*@]+)')
+GLYPH_HEADER_PATTERN = re.compile(r'^0x([0-9a-fA-F]+)')
+
+ATLAS_MAGIC = b'CFNT'
+ATLAS_VERSION = 1
+ATLAS_COVERAGE = 1 << 0     # bitmaps are 8-bit coverage masks (one byte per pixel)
+MAX_GLYPH_WIDTH = 16
+
+
+Glyph = collections.namedtuple('Glyph', ['width', 'rows'])
+# width: advance width in pixels
+# rows:  list of ints, one per row, MSB = leftmost pixel of a width-bit row
+#        (for coverage glyphs: list of lists of 0-255 coverage values)
 
 
 def compile(src: str) -> bytes:
@@ -26,15 +39,210 @@ def compile(src: str) -> bytes:
     return b''.join(result)
 
 
+def parse_txt(src: str, height: int) -> dict:
+    """kernelFont.txt format: "0xNN" followed by rows of '.' and '@'. Only ASCII maps to Unicode."""
+    glyphs = {}
+    code, rows, width = None, [], 0
+
+    for line in src.splitlines() + ['']:
+        m = GLYPH_HEADER_PATTERN.match(line)
+        if m:
+            code, rows = int(m.group(1), 16), []
+            continue
+
+        m = BITMAP_PATTERN.match(line)
+        if m and code is not None:
+            width = len(m.group(1))
+            rows.append(functools.reduce(lambda a, b: 2*a + b,
+                                         [(0 if x == '.' else 1) for x in m.group(1)]))
+            continue
+
+        if code is not None and rows and code < 0x80:
+            glyphs[code] = Glyph(width, fit_rows(rows, height))
+            code, rows = None, []
+
+    return glyphs
+
+
+def parse_hex(src: str, height: int) -> dict:
+    """GNU Unifont .hex format: "XXXX:<32 or 64 hex digits>" (8x16 or 16x16)."""
+    glyphs = {}
+
+    for line in src.splitlines():
+        line = line.strip()
+        if not line or ':' not in line:
+            continue
+
+        code, bitmap = line.split(':', 1)
+        digits_per_row = len(bitmap) // 16
+        width = digits_per_row * 4
+        rows = [int(bitmap[i:i + digits_per_row], 16)
+                for i in range(0, len(bitmap), digits_per_row)]
+        glyphs[int(code, 16)] = Glyph(width, fit_rows(rows, height))
+
+    return glyphs
+
+
+def parse_bdf(src: str, height: int) -> dict:
+    """BDF: glyphs are placed on a cell of the font's bounding box height, aligned on the baseline."""
+    glyphs = {}
+    font_height, font_descent = height, 0
+    code, advance, bbx, rows, in_bitmap = None, 0, (0, 0, 0, 0), [], False
+
+    for line in src.splitlines():
+        fields = line.split()
+        if not fields:
+            continue
+        key = fields[0]
+
+        if key == 'FONTBOUNDINGBOX':
+            font_height, font_descent = int(fields[2]), -int(fields[4])
+        elif key == 'STARTCHAR':
+            code, advance, bbx, rows, in_bitmap = None, 0, (0, 0, 0, 0), [], False
+        elif key == 'ENCODING':
+            code = int(fields[1])
+        elif key == 'DWIDTH':
+            advance = int(fields[1])
+        elif key == 'BBX':
+            bbx = tuple(int(x) for x in fields[1:5])
+        elif key == 'BITMAP':
+            in_bitmap = True
+        elif key == 'ENDCHAR':
+            in_bitmap = False
+            if code is None or code < 0:
+                continue
+
+            w, h, x_offset, y_offset = bbx
+            bytes_per_row = (w + 7) // 8
+            cell = [0] * font_height
+            top = (font_height - font_descent) - (y_offset + h)
+            for i, bits in enumerate(rows):
+                y = top + i
+                if 0 <= y < font_height:
+                    bits >>= bytes_per_row * 8 - w
+                    shift = advance - x_offset - w
+                    cell[y] = bits << shift if shift >= 0 else bits >> -shift
+            glyphs[code] = Glyph(advance, fit_rows(cell, height))
+        elif in_bitmap:
+            rows.append(int(key, 16))
+
+    return glyphs
+
+
+def fit_rows(rows: list, height: int) -> list:
+    """Pad or crop the rows to the atlas height, keeping the glyph vertically centered."""
+    if len(rows) >= height:
+        top = (len(rows) - height) // 2
+        return rows[top:top + height]
+    top = (height - len(rows)) // 2
+    return [0] * top + rows + [0] * (height - len(rows) - top)
+
+
+def to_coverage(glyph: Glyph, scale: int) -> Glyph:
+    """Box-filter a glyph rasterized at scale x the atlas size into 8-bit coverage."""
+    width = (glyph.width + scale - 1) // scale
+    rows = []
+
+    for y in range(len(glyph.rows) // scale):
+        row = []
+        for x in range(width):
+            count = 0
+            for dy in range(scale):
+                bits = glyph.rows[y * scale + dy]
+                for dx in range(scale):
+                    px = x * scale + dx
+                    if px < glyph.width and (bits >> (glyph.width - 1 - px)) & 1:
+                        count += 1
+            row.append((count * 255 + scale * scale // 2) // (scale * scale))
+        rows.append(row)
+
+    return Glyph(width, rows)
+
+
+def pack_atlas(glyphs: dict, height: int, coverage: bool = False) -> bytes:
+    """
+    header  : magic "CFNT", u16 version, u8 height, u8 max_width, u32 num_glyphs, u32 flags
+    entries : num_glyphs x (u32 codepoint | width << 24, u32 bitmap offset), sorted by codepoint
+    bitmaps : height rows per glyph of
+              ceil(width / 8) bytes, MSB = leftmost pixel, or
+              width bytes of 0-255 coverage (flags & ATLAS_COVERAGE)
+    """
+    entries, bitmaps = [], bytearray()
+    max_width = 0
+
+    for code in sorted(glyphs):
+        if code > 0xffffff:
+            continue
+        width, rows = glyphs[code]
+        if width > MAX_GLYPH_WIDTH:
+            if coverage:
+                rows = [row[:MAX_GLYPH_WIDTH] for row in rows]
+            else:
+                rows = [bits >> (width - MAX_GLYPH_WIDTH) for bits in rows]
+            width = MAX_GLYPH_WIDTH
+        if width <= 0:
+            continue
+
+        entries.append(struct.pack('<II', code | (width << 24), len(bitmaps)))
+        if coverage:
+            for row in rows:
+                bitmaps += bytes(row)
+        else:
+            bytes_per_row = (width + 7) // 8
+            for bits in rows:
+                bits <<= bytes_per_row * 8 - width
+                bitmaps += (bits & ((1 << (bytes_per_row * 8)) - 1)).to_bytes(bytes_per_row, 'big')
+        max_width = max(max_width, width)
+
+    flags = ATLAS_COVERAGE if coverage else 0
+    header = struct.pack('<4sHBBII', ATLAS_MAGIC, ATLAS_VERSION, height, max_width, len(entries), flags)
+    return header + b''.join(entries) + bytes(bitmaps)
+
+
+PARSERS = {
+    '.txt': parse_txt,
+    '.hex': parse_hex,
+    '.bdf': parse_bdf,
+}
+
+
+def load_glyphs(path: str, height: int) -> dict:
+    for suffix, parser in PARSERS.items():
+        if path.endswith(suffix):
+            with open(path) as font:
+                return parser(font.read(), height)
+    sys.exit('unknown font format: {}'.format(path))
+
+
 def main():
     parser = argparse.ArgumentParser()
-    parser.add_argument('font', help='path to a font file')
+    parser.add_argument('font', nargs='+', help='path to a font file (.txt, or .hex/.bdf with --atlas)')
     parser.add_argument('-o', help='path to an output file', default='font.out')
+    parser.add_argument('--atlas', action='store_true',
+                        help='pack all fonts into a Unicode glyph atlas (later fonts override earlier ones)')
+    parser.add_argument('--height', type=int, default=16, help='glyph height of the atlas')
+    parser.add_argument('--coverage', action='store_true',
+                        help='store anti-aliased 8-bit coverage masks instead of 1-bit bitmaps')
+    parser.add_argument('--supersample', type=int, default=1,
+                        help='with --coverage: fonts are drawn at N x the atlas height and box-filtered down')
     ns = parser.parse_args()
 
-    with open(ns.o, 'wb') as out, open(ns.font) as font:
-        src = font.read()
-        out.write(compile(src))
+    if not ns.atlas:
+        with open(ns.o, 'wb') as out, open(ns.font[0]) as font:
+            src = font.read()
+            out.write(compile(src))
+        return
+
+    scale = ns.supersample if ns.coverage else 1
+    glyphs = {}
+    for path in ns.font:
+        glyphs.update(load_glyphs(path, ns.height * scale))
+
+    if ns.coverage:
+        glyphs = {code: to_coverage(glyph, scale) for code, glyph in glyphs.items()}
+
+    with open(ns.o, 'wb') as out:
+        out.write(pack_atlas(glyphs, ns.height, ns.coverage))
 
 
 if __name__ == '__main__':